@@ -0,0 +1,709 @@
+// Микробенчмарки горячих функций конвертера: проверка и конвертация одной
+// даты, пакетное ядро, загрузка JSON и генератор корпуса.
+//
+// Каждый случай прогревается, затем число операций подбирается так, чтобы
+// один повтор занимал ~20 мс, и выполняется серия повторов. В отчет идут
+// медиана, среднее, стандартное отклонение и 95% доверительный интервал
+// (время на одну операцию в наносекундах). Результаты пишутся в JSON; при
+// заданном --baseline замедление сверх допуска завершает запуск с кодом 1.
+//
+// Режим --sweep — макробенчмарк масштабирования: корпуса от --min-records до
+// --max-records записей (по степеням 10) обрабатываются на 1..N потоках, для
+// этапов загрузки, проверки, конвертации и записи снимаются МБ/с, записей/с,
+// пиковый RSS и число выделений памяти на запись. Кривые пишутся в CSV и JSON.
+//
+//   date_convertor_bench [--quick] [--filter <подстрока>] [--json <файл>]
+//                        [--baseline <файл>] [--tolerance <проценты>]
+//   date_convertor_bench --sweep [--min-records N] [--max-records N]
+//                        [--max-threads N] [--csv <файл>] [--json <файл>]
+
+#define DATE_CONVERTOR_NO_MAIN
+#include "../date_convertor/date_convertor.cpp"
+
+#include <map>
+#include <new>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Подсчет выделений памяти для режима --sweep. Счетчик включается только на
+// время замера, чтобы не влиять на микробенчмарки. Заменен весь набор
+// operator new/delete (обычные, nothrow, с выравниванием), иначе выделения
+// выровненных типов шли бы мимо счетчика. Выделение и освобождение вынесены
+// в функции без встраивания: иначе GCC видит free() на указателе из
+// operator new и выдает -Wmismatched-new-delete
+namespace bench {
+atomic<bool> count_allocations{ false };
+atomic<uint64_t> allocations{ 0 };
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+
+// nullptr при нехватке памяти; align — 0 для обычного выделения
+BENCH_NOINLINE void* allocate(size_t size, size_t align) noexcept {
+    if (count_allocations.load(memory_order_relaxed)) allocations.fetch_add(1, memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (align == 0) return malloc(size);
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, max(align, sizeof(void*)), size) == 0 ? p : nullptr;
+#endif
+}
+
+BENCH_NOINLINE void release(void* p, bool aligned) noexcept {
+#ifdef _WIN32
+    if (aligned) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)aligned;
+#endif
+    free(p);
+}
+
+void* allocateOrThrow(size_t size, size_t align) {
+    if (void* p = allocate(size, align)) return p;
+    throw bad_alloc();
+}
+}
+
+void* operator new(size_t size) { return bench::allocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return bench::allocateOrThrow(size, 0); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return bench::allocate(size, 0); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return bench::allocate(size, 0); }
+void* operator new(size_t size, align_val_t align) { return bench::allocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, align_val_t align) { return bench::allocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept {
+    return bench::allocate(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept {
+    return bench::allocate(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* p) noexcept { bench::release(p, false); }
+void operator delete[](void* p) noexcept { bench::release(p, false); }
+void operator delete(void* p, size_t) noexcept { bench::release(p, false); }
+void operator delete[](void* p, size_t) noexcept { bench::release(p, false); }
+void operator delete(void* p, const nothrow_t&) noexcept { bench::release(p, false); }
+void operator delete[](void* p, const nothrow_t&) noexcept { bench::release(p, false); }
+void operator delete(void* p, align_val_t) noexcept { bench::release(p, true); }
+void operator delete[](void* p, align_val_t) noexcept { bench::release(p, true); }
+void operator delete(void* p, size_t, align_val_t) noexcept { bench::release(p, true); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { bench::release(p, true); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { bench::release(p, true); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { bench::release(p, true); }
+
+namespace bench {
+
+struct Options {
+    bool quick = false;
+    bool sweep = false;
+    string filter;
+    string json_path;            // по умолчанию bench_results.json / sweep_results.json
+    string csv_path = "sweep_results.csv";
+    long long min_records = 1000;
+    long long max_records = 1000000;
+    unsigned max_threads = 0;    // 0 — по числу ядер
+    string baseline_path;
+    double tolerance = 10.0;     // допустимое замедление, %
+    int repetitions = 15;
+    double repetition_ms = 20.0;
+    double warmup_ms = 50.0;
+};
+
+struct Result {
+    string name;
+    uint64_t ops_per_rep = 0;
+    int reps = 0;
+    double median = 0, mean = 0, stddev = 0, min = 0;
+    double ci_low = 0, ci_high = 0;
+};
+
+// Защита от удаления «бесполезных» вычислений оптимизатором
+volatile uint64_t sink = 0;
+
+using Clock = chrono::steady_clock;
+
+// Квантиль t-распределения Стьюдента для двустороннего 95% интервала
+double tCritical95(int df) {
+    static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (df <= 0) return 0;
+    if (df <= 30) return table[df - 1];
+    return 1.96;
+}
+
+// Один прогон op(iterations); op возвращает число фактически выполненных
+// операций (загрузка и генерация работают целыми файлами)
+template <typename Op>
+double runOnce(Op& op, uint64_t iterations, uint64_t& done) {
+    auto start = Clock::now();
+    done = op(iterations);
+    auto end = Clock::now();
+    return chrono::duration<double, nano>(end - start).count();
+}
+
+template <typename Op>
+Result measure(const string& name, Op op, const Options& opt) {
+    Result r;
+    r.name = name;
+
+    // Калибровка: удваиваем число операций, пока прогон не станет заметным,
+    // затем масштабируем до целевой длительности повтора
+    const double target_ns = opt.repetition_ms * 1e6;
+    uint64_t iterations = 1, done = 0;
+    double ns = runOnce(op, iterations, done);
+    while (ns < target_ns / 8 && iterations < (uint64_t(1) << 40)) {
+        iterations *= 2;
+        ns = runOnce(op, iterations, done);
+    }
+    double per_op = ns / max<uint64_t>(done, 1);
+    iterations = max<uint64_t>(1, static_cast<uint64_t>(target_ns / max(per_op, 0.01)));
+
+    // Прогрев на откалиброванном размере
+    for (double spent = 0; spent < opt.warmup_ms * 1e6;) spent += runOnce(op, iterations, done);
+
+    vector<double> samples;
+    for (int i = 0; i < opt.repetitions; i++) {
+        ns = runOnce(op, iterations, done);
+        samples.push_back(ns / max<uint64_t>(done, 1));
+    }
+    r.ops_per_rep = done;
+    r.reps = static_cast<int>(samples.size());
+
+    sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    r.min = samples.front();
+    r.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    r.mean = accumulate(samples.begin(), samples.end(), 0.0) / n;
+    double sq = 0;
+    for (double s : samples) sq += (s - r.mean) * (s - r.mean);
+    r.stddev = n > 1 ? sqrt(sq / (n - 1)) : 0;
+    double half = tCritical95(static_cast<int>(n) - 1) * r.stddev / sqrt(static_cast<double>(n));
+    r.ci_low = r.mean - half;
+    r.ci_high = r.mean + half;
+    return r;
+}
+
+// Наборы входных дат: 1024 корректные и 1024 некорректные всех категорий
+const size_t kSampleCount = 1024;
+
+vector<string> validSamples() {
+    GeneratorConfig cfg;
+    cfg.error_percent = 0;
+    SplitMix64 rng(1);
+    unsigned weight_sum = 0;
+    for (unsigned w : cfg.error_weights) weight_sum += w;
+    vector<string> out;
+    char buf[11];
+    for (size_t i = 0; i < kSampleCount; i++) {
+        GeneratedRecord rec = drawRecord(cfg, weight_sum, rng);
+        writeDigits(buf, rec.y, 4);
+        buf[4] = '-';
+        writeDigits(buf + 5, rec.m, 2);
+        buf[7] = '-';
+        writeDigits(buf + 8, rec.d, 2);
+        out.emplace_back(buf, 10);
+    }
+    return out;
+}
+
+vector<string> invalidSamples() {
+    static const char* const bad[] = { "2024/12/31", "31-12-2024", "2024-13-45", "2023-02-29",
+        "abcd-ef-gh", "2024-12", "", "2024-12-31-extra", "2024-04-31", "1899-12-31" };
+    const size_t bad_count = sizeof(bad) / sizeof(bad[0]);
+    vector<string> out;
+    for (size_t i = 0; i < kSampleCount; i++) out.emplace_back(bad[i % bad_count]);
+    return out;
+}
+
+template <typename F>
+auto perSample(const vector<string>& samples, F f) {
+    return [&samples, f](uint64_t iterations) {
+        uint64_t acc = 0;
+        for (uint64_t i = 0; i < iterations; i++) acc += f(samples[i & (kSampleCount - 1)]);
+        sink = sink + acc;
+        return iterations;
+    };
+}
+
+// Пакетное ядро: одна операция — одна запись
+auto packedKernel(const vector<string>& samples) {
+    auto packed = make_shared<string>();
+    for (const auto& s : samples) {
+        string padded = s.substr(0, 10);
+        padded.resize(10, ' ');
+        *packed += padded;
+    }
+    auto dmy = make_shared<string>(packed->size(), '\0');
+    auto mdy = make_shared<string>(packed->size(), '\0');
+    auto err = make_shared<vector<DateError>>(kSampleCount);
+    return [=](uint64_t iterations) {
+        for (uint64_t done = 0; done < iterations;) {
+            size_t n = static_cast<size_t>(min<uint64_t>(kSampleCount, iterations - done));
+            convertPackedISO(packed->data(), n, &(*dmy)[0], &(*mdy)[0], err->data());
+            done += n;
+        }
+        sink = sink + static_cast<uint64_t>((*err)[0]) + static_cast<unsigned char>((*dmy)[0]);
+        return iterations;
+    };
+}
+
+const int kRecordsPerFile = 10000;
+
+// Загрузка файла целиком: одна операция — одна запись
+auto loadFile(const string& path) {
+    return [path](uint64_t iterations) {
+        uint64_t records = 0;
+        do {
+            DateFile file = loadDates(path);
+            records += file.records.size();
+        } while (records < iterations);
+        sink = sink + records;
+        return records;
+    };
+}
+
+// Проверка уже загруженного файла: одна операция — одна запись
+auto convertFile(const string& path) {
+    auto file = make_shared<DateFile>(loadDates(path));
+    return [file](uint64_t iterations) {
+        uint64_t records = 0, converted = 0;
+        do {
+            converted += convertRecords(file->records).converted;
+            records += file->records.size();
+        } while (records < iterations);
+        sink = sink + converted;
+        return records;
+    };
+}
+
+// Генерация файлов по kRecordsPerFile записей: одна операция — одна запись
+auto generateInto(const string& dir) {
+    return [dir](uint64_t iterations) {
+        GeneratorConfig cfg;
+        cfg.files = static_cast<int>(max<uint64_t>(1, (iterations + kRecordsPerFile - 1) / kRecordsPerFile));
+        cfg.records_per_file = kRecordsPerFile;
+        cfg.seed = 42;
+        cfg.out_dir = dir;
+        GenerateStats st = generateCorpus(cfg);
+        sink = sink + static_cast<uint64_t>(st.bytes);
+        return static_cast<uint64_t>(st.records);
+    };
+}
+
+// Медианы из ранее сохраненного JSON: пары "name" и "ns_per_op" по порядку
+map<string, double> loadBaseline(const string& path) {
+    map<string, double> baseline;
+    ifstream in(path, ios::binary);
+    string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    const string name_key = "\"name\":\"", value_key = "\"ns_per_op\":";
+    size_t pos = 0;
+    while ((pos = text.find(name_key, pos)) != string::npos) {
+        size_t begin = pos + name_key.size();
+        size_t end = text.find('"', begin);
+        size_t value = text.find(value_key, end);
+        if (end == string::npos || value == string::npos) break;
+        baseline[text.substr(begin, end - begin)] = strtod(text.c_str() + value + value_key.size(), nullptr);
+        pos = value;
+    }
+    return baseline;
+}
+
+bool writeJson(const string& path, const vector<Result>& results, const Options& opt) {
+    simple_json::writer out;
+    if (!out.open(path)) return false;
+    out.begin_object();
+    out.field("simd", simdLevelName(simd_level));
+    out.field("repetitions", static_cast<long long>(opt.repetitions));
+    out.field("repetition_ms", opt.repetition_ms);
+    out.key("benchmarks");
+    out.begin_array();
+    for (const auto& r : results) {
+        out.begin_object();
+        out.field("name", r.name);
+        out.field("ns_per_op", r.median);
+        out.field("mean", r.mean);
+        out.field("stddev", r.stddev);
+        out.field("ci95_low", r.ci_low);
+        out.field("ci95_high", r.ci_high);
+        out.field("min", r.min);
+        out.field("ops_per_rep", static_cast<long long>(r.ops_per_rep));
+        out.field("reps", static_cast<long long>(r.reps));
+        out.end_object();
+    }
+    out.end_array();
+    out.end_object();
+    return out.close();
+}
+
+bool parseArgs(int argc, char* argv[], Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--quick") {
+            opt.quick = true;
+            opt.repetitions = 3;
+            opt.repetition_ms = 2;
+            opt.warmup_ms = 2;
+        }
+        else if (arg == "--filter" && has_value) opt.filter = argv[++i];
+        else if (arg == "--json" && has_value) opt.json_path = argv[++i];
+        else if (arg == "--baseline" && has_value) opt.baseline_path = argv[++i];
+        else if (arg == "--tolerance" && has_value) opt.tolerance = atof(argv[++i]);
+        else if (arg == "--repetitions" && has_value) opt.repetitions = max(2, atoi(argv[++i]));
+        else if (arg == "--sweep") opt.sweep = true;
+        else if (arg == "--min-records" && has_value) opt.min_records = max(1LL, atoll(argv[++i]));
+        else if (arg == "--max-records" && has_value) opt.max_records = max(1LL, atoll(argv[++i]));
+        else if (arg == "--max-threads" && has_value) opt.max_threads = static_cast<unsigned>(max(1, atoi(argv[++i])));
+        else if (arg == "--csv" && has_value) opt.csv_path = argv[++i];
+        else return false;
+    }
+    if (opt.json_path.empty()) opt.json_path = opt.sweep ? "sweep_results.json" : "bench_results.json";
+    return true;
+}
+
+// ===================== РЕЖИМ --sweep =====================
+
+// Пиковый RSS процесса в байтах. На Linux пик сбрасывается перед каждым
+// этапом (запись "5" в /proc/self/clear_refs); где сброс недоступен, это пик
+// с начала работы процесса
+void resetPeakRss() {
+#ifdef __linux__
+    ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+uint64_t peakRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return pmc.PeakWorkingSetSize;
+    return 0;
+#else
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+#endif
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Одна точка кривой: этап на корпусе заданного размера и числе потоков
+struct SweepPoint {
+    long long records = 0;
+    unsigned threads = 0;
+    const char* stage = "";
+    double ms = 0;
+    uint64_t bytes = 0;          // входные байты (запись — выходные)
+    uint64_t peak_rss = 0;
+    uint64_t allocations = 0;
+    double speedup = 0;          // относительно одного потока
+
+    double recordsPerSecond() const { return ms > 0 ? records * 1000.0 / ms : 0; }
+    double megabytesPerSecond() const { return ms > 0 ? bytes / ms / 1000.0 : 0; }
+    double allocationsPerRecord() const { return records ? static_cast<double>(allocations) / records : 0; }
+};
+
+// Замер одного этапа: время, пиковый RSS и выделения памяти
+template <typename F>
+SweepPoint measureStage(const char* stage, long long records, unsigned threads, F&& body) {
+    SweepPoint pt;
+    pt.records = records;
+    pt.threads = threads;
+    pt.stage = stage;
+    resetPeakRss();
+    allocations.store(0, memory_order_relaxed);
+    count_allocations.store(true, memory_order_relaxed);
+    auto start = Clock::now();
+    pt.bytes = body();
+    auto end = Clock::now();
+    count_allocations.store(false, memory_order_relaxed);
+    pt.ms = chrono::duration<double, milli>(end - start).count();
+    pt.allocations = allocations.load(memory_order_relaxed);
+    pt.peak_rss = peakRss();
+    return pt;
+}
+
+// Все этапы на одном корпусе при заданном числе потоков
+vector<SweepPoint> sweepRun(const vector<string>& files, uint64_t input_bytes, long long records,
+    unsigned threads, const fs::path& out_dir) {
+    WorkStealingPool pool(threads);
+    vector<SweepPoint> points;
+    vector<DateFile> data(files.size());
+
+    points.push_back(measureStage("load", records, threads, [&] {
+        pool.parallelFor(files.size(), [&](size_t i, unsigned) { data[i] = loadDates(files[i]); });
+        return input_bytes;
+    }));
+    points.push_back(measureStage("validate", records, threads, [&] {
+        pool.parallelFor(data.size(), [&](size_t i, unsigned) { convertRecords(data[i].records); });
+        return input_bytes;
+    }));
+    points.push_back(measureStage("convert", records, threads, [&] {
+        // Даты в выходном формате строятся при записи; здесь — то же построение без вывода
+        vector<PerThread<uint64_t>> checksum(pool.size());
+        pool.parallelFor(data.size(), [&](size_t i, unsigned worker) {
+            const DateBatch& batch = data[i].records;
+            char buf[10];
+            for (size_t k = 0; k < batch.size(); k++) {
+                if (batch.converted(k)) checksum[worker].value += formatConverted(batch, k, 2, buf)[0];
+            }
+        });
+        for (const auto& c : checksum) sink = sink + c.value;
+        return input_bytes;
+    }));
+
+    error_code ec;
+    fs::create_directories(out_dir, ec);
+    points.push_back(measureStage("write", records, threads, [&] {
+        vector<PerThread<uint64_t>> written(pool.size());
+        pool.parallelFor(data.size(), [&](size_t i, unsigned worker) {
+            unsigned long long bytes = 0;
+            string out = (out_dir / ("converted_" + to_string(i) + ".ndjson")).string();
+            if (saveConverted(out, data[i].records, 2, ExportFormat::Ndjson, &bytes)) written[worker].value += bytes;
+        });
+        uint64_t total = 0;
+        for (const auto& w : written) total += w.value;
+        return total;
+    }));
+    fs::remove_all(out_dir, ec);
+    return points;
+}
+
+bool writeSweepCsv(const string& path, const vector<SweepPoint>& points) {
+    simple_json::writer out;
+    if (!out.open(path)) return false;
+    out.raw("records,threads,stage,ms,records_per_s,mb_per_s,peak_rss_mb,allocs_per_record,speedup\n");
+    char line[256];
+    for (const auto& p : points) {
+        int n = snprintf(line, sizeof(line), "%lld,%u,%s,%.3f,%.0f,%.2f,%.1f,%.3f,%.2f\n",
+            p.records, p.threads, p.stage, p.ms, p.recordsPerSecond(), p.megabytesPerSecond(),
+            p.peak_rss / 1048576.0, p.allocationsPerRecord(), p.speedup);
+        out.raw(string_view(line, static_cast<size_t>(n)));
+    }
+    return out.close();
+}
+
+bool writeSweepJson(const string& path, const vector<SweepPoint>& points) {
+    simple_json::writer out;
+    if (!out.open(path)) return false;
+    out.begin_object();
+    out.field("simd", simdLevelName(simd_level));
+    out.field("hardware_threads", static_cast<long long>(thread::hardware_concurrency()));
+    out.key("points");
+    out.begin_array();
+    for (const auto& p : points) {
+        out.begin_object();
+        out.field("records", p.records);
+        out.field("threads", static_cast<long long>(p.threads));
+        out.field("stage", p.stage);
+        out.field("ms", p.ms);
+        out.field("records_per_s", p.recordsPerSecond());
+        out.field("mb_per_s", p.megabytesPerSecond());
+        out.field("peak_rss_bytes", static_cast<long long>(p.peak_rss));
+        out.field("allocs_per_record", p.allocationsPerRecord());
+        out.field("speedup", p.speedup);
+        out.end_object();
+    }
+    out.end_array();
+    out.end_object();
+    return out.close();
+}
+
+int runSweep(const Options& opt) {
+    unsigned max_threads = opt.max_threads ? opt.max_threads : max(1u, thread::hardware_concurrency());
+    vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    error_code ec;
+    fs::path work = fs::temp_directory_path() / ("date_convertor_sweep_" + to_string(randomSeed()));
+
+    cout << "SIMD: " << simdLevelName(simd_level) << ", потоков: до " << max_threads << "\n\n";
+    cout << right << setw(11) << "записей" << setw(8) << "потоки" << setw(10) << "этап"
+        << setw(12) << "мс" << setw(14) << "записей/с" << setw(10) << "МБ/с"
+        << setw(10) << "RSS МБ" << setw(10) << "выд/зап" << setw(9) << "уск." << "\n";
+    cout << string(94, '-') << "\n";
+
+    vector<SweepPoint> points;
+    for (long long records = opt.min_records; records <= opt.max_records; records *= 10) {
+        // Корпус генерируется один раз на размер, файлами до 10000 записей
+        fs::path corpus = work / ("corpus_" + to_string(records));
+        fs::create_directories(corpus, ec);
+        GeneratorConfig cfg;
+        cfg.records_per_file = static_cast<int>(min<long long>(records, kRecordsPerFile));
+        cfg.files = static_cast<int>(records / cfg.records_per_file);
+        cfg.seed = 42;
+        cfg.out_dir = corpus.string();
+        generateCorpus(cfg);
+        long long actual = static_cast<long long>(cfg.files) * cfg.records_per_file;
+
+        vector<string> files = collectInputs({ corpus.string() });
+        uint64_t input_bytes = 0;
+        for (const auto& f : files) input_bytes += fs::file_size(f, ec);
+
+        map<string, double> single_thread_ms;
+        for (unsigned threads : thread_counts) {
+            for (SweepPoint& p : sweepRun(files, input_bytes, actual, threads, work / "out")) {
+                if (threads == 1) single_thread_ms[p.stage] = p.ms;
+                double base = single_thread_ms.count(p.stage) ? single_thread_ms[p.stage] : 0;
+                p.speedup = p.ms > 0 && base > 0 ? base / p.ms : 0;
+                cout << right << setw(11) << p.records << setw(8) << p.threads << setw(10) << p.stage
+                    << fixed << setprecision(2) << setw(12) << p.ms << setprecision(0) << setw(14) << p.recordsPerSecond()
+                    << setprecision(1) << setw(10) << p.megabytesPerSecond() << setw(10) << p.peak_rss / 1048576.0
+                    << setprecision(2) << setw(10) << p.allocationsPerRecord() << setw(9) << p.speedup << "\n";
+                points.push_back(p);
+            }
+        }
+        fs::remove_all(corpus, ec);
+    }
+    fs::remove_all(work, ec);
+
+    bool ok = writeSweepCsv(opt.csv_path, points) && writeSweepJson(opt.json_path, points);
+    if (!ok) {
+        cerr << "Не удалось записать результаты\n";
+        return 1;
+    }
+    cout << "\nКривые: " << opt.csv_path << ", " << opt.json_path << "\n";
+    return 0;
+}
+
+int run(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        cerr << "Использование: date_convertor_bench [--quick] [--filter <подстрока>] [--json <файл>]\n"
+            << "                            [--baseline <файл>] [--tolerance <проценты>] [--repetitions N]\n"
+            << "       date_convertor_bench --sweep [--min-records N] [--max-records N]\n"
+            << "                            [--max-threads N] [--csv <файл>] [--json <файл>]\n";
+        return 1;
+    }
+    if (opt.sweep) return runSweep(opt);
+
+    // Замеры в одном потоке: результат не зависит от числа ядер машины
+    worker_threads = 1;
+
+    error_code ec;
+    fs::path work = fs::temp_directory_path() / ("date_convertor_bench_" + to_string(randomSeed()));
+    fs::create_directories(work / "valid", ec);
+    fs::create_directories(work / "mixed", ec);
+    fs::create_directories(work / "formats", ec);
+    fs::create_directories(work / "gen", ec);
+
+    GeneratorConfig cfg;
+    cfg.files = 1;
+    cfg.records_per_file = kRecordsPerFile;
+    cfg.seed = 7;
+    cfg.error_percent = 0;
+    cfg.out_dir = (work / "valid").string();
+    generateCorpus(cfg);
+    cfg.format_weights = { 1, 1, 1, 1 };
+    cfg.out_dir = (work / "formats").string();
+    generateCorpus(cfg);
+    cfg.format_weights = GeneratorConfig().format_weights;
+    cfg.error_percent = 30;
+    cfg.out_dir = (work / "mixed").string();
+    generateCorpus(cfg);
+    vector<string> valid_file = collectInputs({ (work / "valid").string() });
+    vector<string> mixed_file = collectInputs({ (work / "mixed").string() });
+    vector<string> formats_file = collectInputs({ (work / "formats").string() });
+
+    const vector<string> valid = validSamples();
+    const vector<string> invalid = invalidSamples();
+
+    struct Case {
+        string name;
+        function<uint64_t(uint64_t)> op;
+    };
+    vector<Case> cases = {
+        { "validISO/valid", perSample(valid, [](const string& s) { return uint64_t(validISO(s)); }) },
+        { "validISO/invalid", perSample(invalid, [](const string& s) { return uint64_t(validISO(s)); }) },
+        { "iso2dmy/valid", perSample(valid, [](const string& s) { return uint64_t(iso2dmy(s).size()); }) },
+        { "iso2dmy/invalid", perSample(invalid, [](const string& s) { return uint64_t(iso2dmy(s).size()); }) },
+        { "iso2mdy/valid", perSample(valid, [](const string& s) { return uint64_t(iso2mdy(s).size()); }) },
+        { "iso2mdy/invalid", perSample(invalid, [](const string& s) { return uint64_t(iso2mdy(s).size()); }) },
+        { "convertPackedISO/valid", packedKernel(valid) },
+        { "convertPackedISO/invalid", packedKernel(invalid) },
+        { "loadDates/valid", loadFile(valid_file.at(0)) },
+        { "loadDates/mixed", loadFile(mixed_file.at(0)) },
+        { "convertRecords/iso", convertFile(valid_file.at(0)) },
+        { "convertRecords/formats", convertFile(formats_file.at(0)) },
+        { "generateCorpus/mixed", generateInto((work / "gen").string()) },
+    };
+
+    map<string, double> baseline;
+    if (!opt.baseline_path.empty()) {
+        baseline = loadBaseline(opt.baseline_path);
+        if (baseline.empty()) {
+            cerr << "Не удалось прочитать базовые результаты: " << opt.baseline_path << "\n";
+            fs::remove_all(work, ec);
+            return 1;
+        }
+    }
+
+    cout << "SIMD: " << simdLevelName(simd_level) << ", повторов: " << opt.repetitions << "\n\n";
+    cout << left << setw(28) << "Случай" << right << setw(12) << "нс/оп" << setw(12) << "±95%"
+        << setw(12) << "база" << setw(10) << "Δ%" << "\n";
+    cout << string(74, '-') << "\n";
+
+    vector<Result> results;
+    int regressions = 0;
+    for (auto& c : cases) {
+        if (!opt.filter.empty() && c.name.find(opt.filter) == string::npos) continue;
+        Result r = measure(c.name, c.op, opt);
+        results.push_back(r);
+
+        cout << left << setw(28) << r.name << right << fixed << setprecision(2)
+            << setw(12) << r.median << setw(12) << (r.ci_high - r.mean);
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && it->second > 0) {
+            double delta = (r.median / it->second - 1) * 100;
+            // Регрессия: медиана вышла за допуск и весь доверительный интервал хуже базы
+            bool regressed = delta > opt.tolerance && r.ci_low > it->second;
+            regressions += regressed;
+            cout << setw(12) << it->second << setw(9) << setprecision(1) << showpos << delta << noshowpos
+                << (regressed ? "  РЕГРЕССИЯ" : "");
+        }
+        cout << "\n";
+    }
+
+    fs::remove_all(work, ec);
+
+    if (!writeJson(opt.json_path, results, opt)) {
+        cerr << "Не удалось записать " << opt.json_path << "\n";
+        return 1;
+    }
+    cout << "\nРезультаты: " << opt.json_path << "\n";
+
+    if (regressions > 0) {
+        cout << "Регрессий производительности: " << regressions << " (допуск " << opt.tolerance << "%)\n";
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace bench
+
+int main(int argc, char* argv[]) {
+    return bench::run(argc, argv);
+}
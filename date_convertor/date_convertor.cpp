@@ -11,63 +11,560 @@
 #include <cmath>
 #include <sstream>
 #include <random>
+#include <array>
+#include <cstdint>
+#include <climits>
+#include <filesystem>
+#include <cstring>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <csignal>
+#include <cerrno>
+#endif
+
+// io_uring без liburing: только системные вызовы и заголовок ядра
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define DC_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+// Аппаратные счетчики: perf_event_open без libpfm и perf
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/perf_event.h>)
+#define DC_PERF_EVENTS 1
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "date_core.h"
 
 using namespace std;
+namespace fs = std::filesystem;
 
-// Простая JSON-реализация
+// Простая JSON-реализация: потоковая запись без промежуточных объектов.
+// Токены пишутся в переиспользуемый буфер фиксированного размера, который
+// сбрасывается в файловый дескриптор целыми блоками.
 namespace simple_json {
-    class object {
-        vector<pair<string, string>> data;
+    class writer {
+        unique_ptr<char[]> buf;
+        size_t cap;
+        size_t len = 0;
+        int fd = -1;
+        bool owns_fd = true;  // false — чужой дескриптор (stdout), не закрывается
+        bool failed = false;
+        unsigned long long written = 0;
+        // Флаг «в текущем контейнере уже есть элемент» для каждого уровня вложенности
+        bool has_item[64] = {};
+        int depth = 0;
+        bool after_key = false;
+
     public:
-        void add(const string& key, const string& val) {
-            data.emplace_back(key, val);
+        explicit writer(size_t block = 1 << 20) : buf(new char[block]), cap(block) {}
+
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        ~writer() { close(); }
+
+        // Открытие файла на запись; буфер переиспользуется между файлами
+        bool open(const string& path) {
+            close();
+#ifdef _WIN32
+            fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+            owns_fd = true;
+            return reset();
         }
-        string dump() const {
-            string result = "{";
-            for (size_t i = 0; i < data.size(); ++i) {
-                if (i > 0) result += ",";
-                result += "\"" + data[i].first + "\":\"" + data[i].second + "\"";
+
+        // Запись в уже открытый дескриптор (например, 1 — stdout); close()
+        // только сбрасывает буфер
+        bool attach(int descriptor) {
+            close();
+            fd = descriptor;
+            owns_fd = false;
+            return reset();
+        }
+
+        // Сброс остатка и закрытие; false — была ошибка записи
+        bool close() {
+            if (fd < 0) return !failed;
+            flush();
+            if (owns_fd) {
+#ifdef _WIN32
+                if (_close(fd) != 0) failed = true;
+#else
+                if (::close(fd) != 0) failed = true;
+#endif
             }
-            result += "}";
-            return result;
+            fd = -1;
+            return !failed;
         }
-    };
 
-    class array {
-        vector<object> objects;
-    public:
-        void add(const object& obj) {
-            objects.push_back(obj);
+        bool ok() const { return !failed; }
+        unsigned long long bytes() const { return written + len; }
+
+        void begin_array() { open_container('['); }
+        void end_array() { close_container(']'); }
+        void begin_object() { open_container('{'); }
+        void end_object() { close_container('}'); }
+
+        void key(string_view k) {
+            char* p = reserve(k.size() * 6 + 4);
+            p = separate(p);
+            p = put_string(p, k);
+            *p++ = ':';
+            commit(p);
+            after_key = true;
+        }
+
+        void value(string_view v) {
+            char* p = reserve(v.size() * 6 + 3);
+            p = separate(p);
+            commit(put_string(p, v));
+        }
+
+        void value(long long v) {
+            char* p = reserve(24);
+            p = separate(p);
+            commit(p + snprintf(p, 22, "%lld", v));
+        }
+
+        // Конечное число с 9 значащими цифрами; NaN и бесконечность — null
+        void value(double v) {
+            char* p = reserve(32);
+            p = separate(p);
+            if (std::isfinite(v)) p += snprintf(p, 30, "%.9g", v);
+            else { memcpy(p, "null", 4); p += 4; }
+            commit(p);
+        }
+
+        void field(string_view k, string_view v) {
+            key(k);
+            value(v);
+        }
+
+        void field(string_view k, long long v) {
+            key(k);
+            value(v);
+        }
+
+        void field(string_view k, double v) {
+            key(k);
+            value(v);
+        }
+
+        // Байты как есть, вне структуры JSON (строки CSV)
+        void raw(string_view bytes) {
+            if (bytes.empty()) return;
+            char* p = reserve(bytes.size());
+            memcpy(p, bytes.data(), bytes.size());
+            commit(p + bytes.size());
+        }
+
+        // Конец документа верхнего уровня в NDJSON: следующий пишется с новой строки без запятой
+        void end_line() {
+            raw("\n");
+            has_item[depth] = false;
+        }
+
+        // Готовый JSON-фрагмент как значение (без проверки)
+        void raw_value(string_view json) {
+            char* p = reserve(json.size() + 1);
+            p = separate(p);
+            memcpy(p, json.data(), json.size());
+            commit(p + json.size());
+        }
+
+        void flush() {
+            const char* p = buf.get();
+            size_t left = len;
+            while (left > 0 && fd >= 0 && !failed) {
+#ifdef _WIN32
+                int n = _write(fd, p, static_cast<unsigned>(min<size_t>(left, 1u << 30)));
+#else
+                ssize_t n = ::write(fd, p, left);
+#endif
+                if (n <= 0) {
+                    failed = true;
+                    break;
+                }
+                p += n;
+                left -= static_cast<size_t>(n);
+            }
+            written += len;
+            len = 0;
+        }
+
+    private:
+        bool reset() {
+            failed = fd < 0;
+            written = 0;
+            depth = 0;
+            after_key = false;
+            has_item[0] = false;
+            return !failed;
+        }
+
+        // Место под n байт подряд; запись идет через локальный указатель,
+        // чтобы компилятор не перечитывал поля объекта после каждого байта
+        char* reserve(size_t n) {
+            if (len + n > cap) {
+                flush();
+                if (n > cap) {
+                    buf.reset(new char[n]);
+                    cap = n;
+                }
+            }
+            return buf.get() + len;
+        }
+
+        void commit(char* end) {
+            len = static_cast<size_t>(end - buf.get());
+        }
+
+        char* separate(char* p) {
+            if (after_key) {
+                after_key = false;
+                return p;
+            }
+            if (has_item[depth]) *p++ = ',';
+            has_item[depth] = true;
+            return p;
         }
-        string dump() const {
-            string result = "[";
-            for (size_t i = 0; i < objects.size(); ++i) {
-                if (i > 0) result += ",";
-                result += objects[i].dump();
+
+        void open_container(char c) {
+            char* p = separate(reserve(2));
+            *p++ = c;
+            commit(p);
+            if (depth < 63) has_item[++depth] = false;
+        }
+
+        void close_container(char c) {
+            char* p = reserve(1);
+            *p++ = c;
+            commit(p);
+            if (depth > 0) depth--;
+        }
+
+        // Длина начала строки, которое не требует экранирования. Проверка по
+        // 8 байт: в слове нет '"', '\\' и управляющих символов (< 0x20)
+        static size_t plainPrefix(const char* s, size_t n) {
+            const uint64_t ones = 0x0101010101010101ull, highs = 0x8080808080808080ull;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint64_t x;
+                memcpy(&x, s + i, 8);
+                uint64_t q = x ^ (ones * '"'), b = x ^ (ones * '\\');
+                uint64_t special = ((x - ones * 0x20) | (q - ones) | (b - ones)) & ~x & highs;
+                if (special) break;
+            }
+            for (; i < n; i++) {
+                unsigned char c = static_cast<unsigned char>(s[i]);
+                if (c < 0x20 || c == '"' || c == '\\') break;
+            }
+            return i;
+        }
+
+        // Строка в кавычках; экранирование только там, где оно нужно.
+        // Требует s.size() * 6 + 2 байт места
+        static char* put_string(char* p, string_view s) {
+            *p++ = '"';
+            size_t i = 0;
+            while (true) {
+                size_t plain = plainPrefix(s.data() + i, s.size() - i);
+                memcpy(p, s.data() + i, plain);
+                p += plain;
+                i += plain;
+                if (i == s.size()) break;
+
+                unsigned char c = static_cast<unsigned char>(s[i++]);
+                *p++ = '\\';
+                switch (c) {
+                case '"': *p++ = '"'; break;
+                case '\\': *p++ = '\\'; break;
+                case '\n': *p++ = 'n'; break;
+                case '\r': *p++ = 'r'; break;
+                case '\t': *p++ = 't'; break;
+                case '\b': *p++ = 'b'; break;
+                case '\f': *p++ = 'f'; break;
+                default: {
+                    static const char hex[] = "0123456789abcdef";
+                    *p++ = 'u'; *p++ = '0'; *p++ = '0';
+                    *p++ = hex[c >> 4];
+                    *p++ = hex[c & 15];
+                }
+                }
             }
-            result += "]";
-            return result;
+            *p++ = '"';
+            return p;
         }
     };
 }
 
-struct DateRecord {
-    string name;
-    string iso;
-    string dmy;
-    string mdy;
-    bool conv = false;
-    bool has_error = false;
-    bool is_correct = true;  // Новое поле для отслеживания корректности
+// Счетчики ошибок по категориям
+struct ErrorCounts {
+    array<long long, kDateErrorCount> by_kind{};
+
+    void add(DateError e) { by_kind[static_cast<int>(e)]++; }
+    void merge(const ErrorCounts& other) {
+        for (int i = 0; i < kDateErrorCount; i++) by_kind[i] += other.by_kind[i];
+    }
+    long long operator[](DateError e) const { return by_kind[static_cast<int>(e)]; }
+};
+
+// Ссылка на строку записи: смещение и длина в исходном тексте файла или,
+// если установлен kDecodedBit в длине, в буфере раскодированных строк
+struct TextRef {
+    static const uint32_t kDecodedBit = 0x80000000u;
+    uint32_t offset = 0;
+    uint32_t length = 0;
 };
 
+// Записи файла по столбцам (~21 байт на запись вместо отдельного объекта
+// со строками): ссылки на name и date_iso, номер дня и код ошибки. Даты в
+// выходных форматах не хранятся — они строятся из date_iso при записи.
+struct DateBatch {
+    string_view source;              // текст файла (отображение, см. DateFile)
+    string decoded;                  // строки с escape-последовательностями
+    vector<TextRef> names;
+    vector<TextRef> isos;
+    vector<int32_t> ordinals;        // номер дня от 01.01.kMinYear, -1 — нет
+    vector<DateError> errors;        // MissingField — с загрузки, остальное — при проверке
+
+    size_t size() const { return errors.size(); }
+    bool empty() const { return errors.empty(); }
+
+    string_view text(TextRef r) const {
+        if (r.length & TextRef::kDecodedBit) {
+            return string_view(decoded.data() + r.offset, r.length & ~TextRef::kDecodedBit);
+        }
+        return source.substr(r.offset, r.length);
+    }
+    string_view name(size_t i) const { return text(names[i]); }
+    string_view iso(size_t i) const { return text(isos[i]); }
+
+    // Запись прошла проверку (после convertRecords)
+    bool converted(size_t i) const { return ordinals[i] >= 0; }
+
+    // Ссылка на фрагмент source
+    TextRef sourceRef(string_view s) const {
+        return { static_cast<uint32_t>(s.data() - source.data()), static_cast<uint32_t>(s.size()) };
+    }
+
+    // Копия строки в decoded
+    TextRef decodedRef(string_view s) {
+        TextRef r{ static_cast<uint32_t>(decoded.size()), static_cast<uint32_t>(s.size()) | TextRef::kDecodedBit };
+        decoded.append(s.data(), s.size());
+        return r;
+    }
+
+    void push(TextRef name, TextRef iso, bool missing_field) {
+        names.push_back(name);
+        isos.push_back(iso);
+        ordinals.push_back(-1);
+        errors.push_back(missing_field ? DateError::MissingField : DateError::None);
+    }
+
+    void reserve(size_t n) {
+        names.reserve(n);
+        isos.reserve(n);
+        ordinals.reserve(n);
+        errors.reserve(n);
+    }
+
+    // Очистка с сохранением выделенной памяти (пакеты потокового режима)
+    void clear() {
+        source = string_view();
+        decoded.clear();
+        names.clear();
+        isos.clear();
+        ordinals.clear();
+        errors.clear();
+    }
+};
+
+// ===================== АППАРАТНЫЕ СЧЕТЧИКИ =====================
+// Счетчики процессора за этап конвейера через perf_event_open (Linux): такты,
+// инструкции, промахи предсказания ветвлений, промахи L1d и последнего уровня
+// кэша, страничные ошибки. Счетчики открываются на каждый поток процесса
+// (главный и пул) с inherit, поэтому учитываются и потоки, созданные на этапе
+// (поток чтения конвейера), — после их завершения. Считается только
+// пользовательский код. Если событие недоступно (perf_event_paranoid,
+// виртуальная машина без PMU), у него нет значения, остальные считаются.
+
+enum class PerfEvent { Cycles, Instructions, BranchMisses, L1Misses, LlcMisses, PageFaults, Count };
+const int kPerfEventCount = static_cast<int>(PerfEvent::Count);
+
+// Значения событий за этап, сумма по потокам; -1 — событие недоступно
+struct PerfSample {
+    array<double, kPerfEventCount> value;
+
+    PerfSample() { value.fill(-1); }
+    bool has(PerfEvent e) const { return value[static_cast<int>(e)] >= 0; }
+    double operator[](PerfEvent e) const { return value[static_cast<int>(e)]; }
+    bool any() const {
+        for (double v : value) if (v >= 0) return true;
+        return false;
+    }
+};
+
+class PerfCounters {
+#ifdef DC_PERF_EVENTS
+    vector<array<int, kPerfEventCount>> fds;  // по потоку; -1 — не открыт
+
+    static perf_event_attr eventAttr(PerfEvent e) {
+        perf_event_attr a;
+        memset(&a, 0, sizeof(a));
+        a.size = sizeof(a);
+        a.disabled = 1;
+        a.inherit = 1;
+        a.exclude_kernel = 1;
+        a.exclude_hv = 1;
+        a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        a.type = PERF_TYPE_HARDWARE;
+        switch (e) {
+        case PerfEvent::Cycles: a.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PerfEvent::Instructions: a.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PerfEvent::BranchMisses: a.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case PerfEvent::L1Misses:
+            a.type = PERF_TYPE_HW_CACHE;
+            a.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerfEvent::LlcMisses: a.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        default:
+            a.type = PERF_TYPE_SOFTWARE;
+            a.config = PERF_COUNT_SW_PAGE_FAULTS;
+            break;
+        }
+        return a;
+    }
+#endif
+    string error;  // первая ошибка открытия
+
+public:
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() { stop(); }
+
+    // Открытие и запуск на всех потоках процесса; false — ни одно событие недоступно
+    bool start() {
+        stop();
+        error.clear();
+#ifdef DC_PERF_EVENTS
+        error_code ec;
+        bool opened = false;
+        for (const auto& task : fs::directory_iterator("/proc/self/task", ec)) {
+            pid_t tid = static_cast<pid_t>(atoi(task.path().filename().c_str()));
+            array<int, kPerfEventCount> thread_fds;
+            for (int k = 0; k < kPerfEventCount; k++) {
+                perf_event_attr a = eventAttr(static_cast<PerfEvent>(k));
+                thread_fds[k] = static_cast<int>(syscall(SYS_perf_event_open, &a, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+                if (thread_fds[k] >= 0) opened = true;
+                else if (error.empty()) error = string("perf_event_open: ") + strerror(errno);
+            }
+            fds.push_back(thread_fds);
+        }
+        for (const auto& thread_fds : fds) {
+            for (int fd : thread_fds) {
+                if (fd < 0) continue;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+        if (!opened && error.empty()) error = "нет потоков в /proc/self/task";
+        return opened;
+#else
+        error = "perf_event_open есть только в Linux";
+        return false;
+#endif
+    }
+
+    // Остановка и сумма по потокам с поправкой на мультиплексирование
+    // (счетчик работал не все время этапа)
+    PerfSample stop() {
+        PerfSample sample;
+#ifdef DC_PERF_EVENTS
+        for (const auto& thread_fds : fds) {
+            for (int k = 0; k < kPerfEventCount; k++) {
+                int fd = thread_fds[k];
+                if (fd < 0) continue;
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                uint64_t data[3];  // значение, время включения, время работы
+                if (read(fd, data, sizeof(data)) == static_cast<ssize_t>(sizeof(data))) {
+                    double v = data[2] ? static_cast<double>(data[0]) * data[1] / data[2] : 0.0;
+                    sample.value[k] = max(sample.value[k], 0.0) + v;
+                }
+                ::close(fd);
+            }
+        }
+        fds.clear();
+#endif
+        return sample;
+    }
+
+    // Причина недоступности для вывода пользователю
+    const string& unavailable() const { return error; }
+};
+
+// Этапы конвейера бенчмарка
+enum BenchmarkStage { StageLoad, StageParse, StageValidate, StageConvert, StageWrite, kBenchmarkStages };
+const char* const kBenchmarkStageNames[kBenchmarkStages] = {
+    "Загрузка", "Разбор", "Проверка", "Конвертация", "Выгрузка"
+};
+const char* const kBenchmarkStageKeys[kBenchmarkStages] = {
+    "load_ms", "parse_ms", "validate_ms", "convert_ms", "write_ms"
+};
+
+// Время этапов в миллисекундах с дробной частью (измеряется в микросекундах,
+// чтобы маленький корпус не округлялся до 0 мс)
 struct BenchmarkResult {
-    int records_processed;
-    long long load_time_ms;
-    long long convert_time_ms;
-    long long validation_time_ms;
-    long long total_time_ms;
-    double records_per_second;
+    long long records_processed = 0;
+    unsigned long long input_bytes = 0;
+    unsigned long long export_bytes = 0;
+    // Загрузка — чтение файлов, разбор — JSON в пакеты, проверка — convertRecords,
+    // конвертация — даты в новом формате в памяти, выгрузка — запись NDJSON
+    array<double, kBenchmarkStages> stage_ms{};
+    double total_time_ms = 0;
+    double records_per_second = 0;
+    bool counters = false;                                // счетчики собирались
+    string counters_error;                                // почему недоступны
+    array<PerfSample, kBenchmarkStages> stage_counters;
 };
 
 // Глобальные переменные для тестирования
@@ -76,17 +573,266 @@ int total_tests_run = 0;
 int passed_tests = 0;
 
 void printHeader(const string& title) {
-    cout << "\n" << string(60, '=') << endl;
-    cout << "  " << title << endl;
-    cout << string(60, '=') << endl;
+    cout << "\n" << string(60, '=') << "\n";
+    cout << "  " << title << "\n";
+    cout << string(60, '=') << "\n";
 }
 
 void printTableHeader() {
     cout << left << setw(20) << "Тест"
         << setw(15) << "Записей"
         << setw(15) << "Время (мс)"
-        << setw(15) << "Статус" << endl;
-    cout << string(65, '-') << endl;
+        << setw(15) << "Статус" << "\n";
+    cout << string(65, '-') << "\n";
+}
+
+// ===================== ОТЧЕТЫ =====================
+// Итоги команд (конвертация, анализ, генерация, бенчмарк) выводятся через
+// ReportSink, а не прямо в cout: отчет копится в буфере и выводится одной
+// записью в end(), без сброса потока на каждой строке. Реализации: таблица
+// для человека, однострочный key=value пакетного режима, JSON (объект на
+// отчет, по строке) и тихий режим, который только собирает значения.
+// key — машинное имя поля, label — подпись в таблице
+
+enum class ReportFormat { Text, Line, Json, Quiet };
+
+bool parseReportFormat(const string& name, ReportFormat& format) {
+    if (name == "text") format = ReportFormat::Text;
+    else if (name == "line") format = ReportFormat::Line;
+    else if (name == "json") format = ReportFormat::Json;
+    else if (name == "quiet") format = ReportFormat::Quiet;
+    else return false;
+    return true;
+}
+
+// Ячейка таблицы: setw считает байты, а не символы UTF-8
+string padded(string_view text, size_t width) {
+    size_t chars = 0;
+    for (char c : text) chars += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    return string(text) + string(chars < width ? width - chars : 1, ' ');
+}
+
+class ReportSink {
+public:
+    virtual ~ReportSink() = default;
+
+    // Начало отчета; пустой title — без заголовка в таблице
+    virtual void begin(const char* name, const string& title) = 0;
+    // Группа полей (в JSON — вложенный объект) до end_section()
+    virtual void section(const char* key, const string& title) = 0;
+    virtual void end_section() = 0;
+    virtual void count(const char* key, const char* label, long long value, const char* unit = "") = 0;
+    virtual void number(const char* key, const char* label, double value, const char* unit = "", int precision = 2) = 0;
+    virtual void text(const char* key, const char* label, string_view value) = 0;
+    // Строка только для человека (примеры, таблицы); остальные форматы ее пропускают
+    virtual void note(string_view) {}
+    // Конец отчета: накопленное выводится одной записью
+    virtual void end() = 0;
+};
+
+// Поля вне групп выводятся сразу под заголовком, группы и строки для
+// человека — после них в порядке вызовов
+class TextReport : public ReportSink {
+    string head, body;
+    string* out = &head;
+
+    static const size_t kLabelWidth = 30;
+
+    void line(const char* label, string_view value, const char* unit) {
+        *out += padded(label, kLabelWidth);
+        *out += value;
+        *out += unit;
+        *out += '\n';
+    }
+
+public:
+    void begin(const char*, const string& title) override {
+        out = &head;
+        if (title.empty()) return;
+        head += "\n" + string(60, '=') + "\n  " + title + "\n" + string(60, '=') + "\n";
+    }
+
+    void section(const char*, const string& title) override {
+        out = &body;
+        body += "\n=== " + title + " ===\n";
+    }
+
+    void end_section() override { out = &head; }
+
+    void count(const char*, const char* label, long long value, const char* unit) override {
+        line(label, to_string(value), unit);
+    }
+
+    void number(const char*, const char* label, double value, const char* unit, int precision) override {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", precision, value);
+        line(label, buf, unit);
+    }
+
+    void text(const char*, const char* label, string_view value) override {
+        line(label, value, "");
+    }
+
+    void note(string_view text) override {
+        body += text;
+        body += '\n';
+    }
+
+    void end() override {
+        head += body;
+        cout.write(head.data(), static_cast<streamsize>(head.size()));
+        head.clear();
+        body.clear();
+        out = &head;
+    }
+};
+
+// "name key=value ..." одной строкой; группы полей не выделяются
+class LineReport : public ReportSink {
+    string out;
+
+public:
+    void begin(const char* name, const string&) override { out = name; }
+    void section(const char*, const string&) override {}
+    void end_section() override {}
+
+    void count(const char* key, const char*, long long value, const char*) override {
+        out += ' ';
+        out += key;
+        out += '=';
+        out += to_string(value);
+    }
+
+    void number(const char* key, const char*, double value, const char*, int precision) override {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", precision, value);
+        out += ' ';
+        out += key;
+        out += '=';
+        out += buf;
+    }
+
+    void text(const char* key, const char*, string_view value) override {
+        out += ' ';
+        out += key;
+        out += '=';
+        out += value;
+    }
+
+    void end() override {
+        out += '\n';
+        cout.write(out.data(), static_cast<streamsize>(out.size()));
+        out.clear();
+    }
+};
+
+// Объект {"report": name, ...} на строку; пишется прямо в stdout через буфер writer'а
+class JsonReport : public ReportSink {
+    simple_json::writer out{ 1 << 16 };
+    bool in_section = false;
+
+public:
+    void begin(const char* name, const string&) override {
+        cout.flush();  // подсказки меню уже в stdout до отчета
+#ifdef _WIN32
+        out.attach(_fileno(stdout));
+#else
+        out.attach(STDOUT_FILENO);
+#endif
+        out.begin_object();
+        out.field("report", string_view(name));
+    }
+
+    void section(const char* key, const string&) override {
+        end_section();
+        out.key(key);
+        out.begin_object();
+        in_section = true;
+    }
+
+    void end_section() override {
+        if (!in_section) return;
+        out.end_object();
+        in_section = false;
+    }
+
+    void count(const char* key, const char*, long long value, const char*) override { out.field(key, value); }
+    void number(const char* key, const char*, double value, const char*, int) override { out.field(key, value); }
+    void text(const char* key, const char*, string_view value) override { out.field(key, value); }
+
+    void end() override {
+        end_section();
+        out.end_object();
+        out.end_line();
+        out.close();
+    }
+};
+
+// Ничего не выводит: значения последнего отчета доступны через value()
+// ("section.key" для полей группы)
+class QuietReport : public ReportSink {
+    vector<pair<string, double>> values;
+    string prefix;
+
+    void add(const char* key, double value) {
+        values.emplace_back(prefix + key, value);
+    }
+
+public:
+    void begin(const char*, const string&) override {
+        values.clear();
+        prefix.clear();
+    }
+
+    void section(const char* key, const string&) override { prefix = string(key) + "."; }
+    void end_section() override { prefix.clear(); }
+    void count(const char* key, const char*, long long value, const char*) override { add(key, static_cast<double>(value)); }
+    void number(const char* key, const char*, double value, const char*, int) override { add(key, value); }
+    void text(const char*, const char*, string_view) override {}
+    void end() override {}
+
+    // Значение поля; -1 — поля не было
+    double value(const string& key) const {
+        for (const auto& v : values) {
+            if (v.first == key) return v.second;
+        }
+        return -1;
+    }
+};
+
+unique_ptr<ReportSink> makeReport(ReportFormat format) {
+    switch (format) {
+    case ReportFormat::Line: return make_unique<LineReport>();
+    case ReportFormat::Json: return make_unique<JsonReport>();
+    case ReportFormat::Quiet: return make_unique<QuietReport>();
+    default: return make_unique<TextReport>();
+    }
+}
+
+// Формат отчетов меню (date_convertor menu --report ...)
+ReportFormat menu_report_format = ReportFormat::Text;
+
+// Строки по каждому файлу (--verbose); по умолчанию только итог
+bool report_files = false;
+
+// Кэш разбора при анализе из меню (date_convertor menu --cache)
+bool menu_cache = false;
+
+ReportSink& menuReport() {
+    static unique_ptr<ReportSink> sink = makeReport(menu_report_format);
+    return *sink;
+}
+
+// Ненулевые категории ошибок: в таблице — по названию, в остальных
+// форматах — по коду (wrong_separator=...)
+void reportErrorCounts(ReportSink& report, const ErrorCounts& ec) {
+    report.section("error_kinds", "ОШИБКИ ПО КАТЕГОРИЯМ");
+    for (int i = 1; i < kDateErrorCount; i++) {
+        if (ec.by_kind[i] == 0) continue;
+        DateError e = static_cast<DateError>(i);
+        report.count(dateErrorCode(e), dateErrorName(e), ec.by_kind[i]);
+    }
+    report.end_section();
 }
 
 void help() {
@@ -101,635 +847,4600 @@ void help() {
         << "0) Выход из программы\n";
 }
 
-bool validISO(const string& s) {
-    if (s.length() != 10) return false;
-    if (s[4] != '-' || s[7] != '-') return false;
+// ===================== ЗАГРУЗКА JSON =====================
+// Файл отображается в память целиком, записи ссылаются на байты отображения
+// (string_view) без копирования полей. Копия создается только для значений
+// с escape-последовательностями.
+
+// Отображение файла в память только для чтения
+class MappedFile {
+    const char* ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (ptr) len = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                ptr = static_cast<const char*>(p);
+                len = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-    try {
-        int year = stoi(s.substr(0, 4));
-        int month = stoi(s.substr(5, 2));
-        int day = stoi(s.substr(8, 2));
+    MappedFile(MappedFile&& other) noexcept {
+        *this = move(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            ptr = exchange(other.ptr, nullptr);
+            len = exchange(other.len, 0);
+#ifdef _WIN32
+            file = exchange(other.file, INVALID_HANDLE_VALUE);
+            mapping = exchange(other.mapping, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    ~MappedFile() { release(); }
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+    string_view view() const { return string_view(ptr, len); }
+
+private:
+    void release() {
+#ifdef _WIN32
+        if (ptr) UnmapViewOfFile(ptr);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#else
+        if (ptr) munmap(const_cast<char*>(ptr), len);
+#endif
+        ptr = nullptr;
+        len = 0;
+    }
+};
+
+// Загруженный файл: отображение и записи со ссылками в него. Смещения
+// 32-битные, поэтому файл больше 4 ГБ разбирается только до этой границы
+// (и помечается как malformed)
+struct DateFile {
+    MappedFile map;
+    unique_ptr<char[]> owned;  // текст, прочитанный конвейером (вместо отображения)
+    DateBatch records;
+    bool malformed = false;  // разбор остановлен на синтаксической ошибке
+};
+
+// Разбор JSON: массив объектов (или объекты подряд, по одному на строку)
+// с произвольными пробелами, порядком ключей и escape-последовательностями
+class DateJsonParser {
+    const char* p;
+    const char* end;
+    DateBatch& out;
+    // Раскодированные значения, уже сохраненные в out.decoded: хеш -> ссылка.
+    // Повторяющаяся строка с escape-последовательностями хранится один раз
+    unordered_multimap<size_t, TextRef> interned;
+
+public:
+    DateJsonParser(DateBatch& batch) : p(batch.source.data()), end(batch.source.data() + batch.source.size()), out(batch) {
+        if (batch.source.size() > UINT32_MAX) end = p + UINT32_MAX;
+    }
+
+    bool parse() {
+        if (end - p >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;  // BOM
+        skipWs();
+        if (p == end) return true;
+
+        bool in_array = *p == '[';
+        if (in_array) {
+            p++;
+            skipWs();
+            if (p < end && *p == ']') return true;
+        }
+
+        while (true) {
+            skipWs();
+            if (p == end) return !in_array;
+            if (*p != '{' || !parseObject()) return false;
+            skipWs();
+            if (p == end) return !in_array;
+            if (*p == ',') {
+                p++;
+            }
+            else if (in_array && *p == ']') {
+                return true;
+            }
+            else if (in_array) {
+                return false;
+            }
+        }
+    }
+
+private:
+    void skipWs() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    // Строка без кавычек; p указывает на открывающую кавычку. Строка без
+    // escape-последовательностей ссылается в исходный текст, иначе
+    // раскодируется в конец out.decoded (вызывающий либо сохраняет ее через
+    // valueRef, либо откатывает буфер до прежнего размера)
+    bool parseString(string_view& value) {
+        const char* start = ++p;
+        const char* quote = static_cast<const char*>(memchr(p, '"', end - p));
+        if (!quote) return false;
+        if (!memchr(start, '\\', quote - start)) {
+            value = string_view(start, quote - start);
+            p = quote + 1;
+            return true;
+        }
+        return parseEscapedString(start, value);
+    }
+
+    bool parseEscapedString(const char* start, string_view& value) {
+        string& decoded = out.decoded;
+        size_t mark = decoded.size();
+        p = start;
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                const char* run = p;
+                while (p < end && *p != '"' && *p != '\\') p++;
+                decoded.append(run, p - run);
+                continue;
+            }
+            if (++p == end) return false;
+            char c = *p++;
+            switch (c) {
+            case '"': case '\\': case '/': decoded += c; break;
+            case 'b': decoded += '\b'; break;
+            case 'f': decoded += '\f'; break;
+            case 'n': decoded += '\n'; break;
+            case 'r': decoded += '\r'; break;
+            case 't': decoded += '\t'; break;
+            case 'u': {
+                unsigned cp;
+                if (!parseHex4(cp)) return false;
+                // Пара суррогатов — один символ; одиночный суррогат (в том
+                // числе старший без младшего DC00-DFFF) заменяется на U+FFFD,
+                // а следующая за ним последовательность разбирается как обычно
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    const char* next = p;
+                    unsigned low = 0;
+                    if (end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        p += 2;
+                        if (!parseHex4(low)) return false;
+                    }
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    else {
+                        p = next;
+                        cp = 0xFFFD;
+                    }
+                }
+                else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    cp = 0xFFFD;
+                }
+                appendUtf8(decoded, cp);
+                break;
+            }
+            default: return false;
+            }
+        }
+        if (p == end) return false;
+        p++;
+        value = string_view(decoded).substr(mark);
+        return true;
+    }
 
-        if (year < 1900 || year > 2100) return false;
-        if (month < 1 || month > 12) return false;
-        if (day < 1 || day > 31) return false;
+    bool parseHex4(unsigned& cp) {
+        if (end - p < 4) return false;
+        cp = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *p++;
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
 
-        if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30) return false;
-        if (month == 2) {
-            bool isLeap = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-            if (day > (isLeap ? 29 : 28)) return false;
+    static void appendUtf8(string& s, unsigned cp) {
+        if (cp < 0x80) {
+            s += static_cast<char>(cp);
+        }
+        else if (cp < 0x800) {
+            s += static_cast<char>(0xC0 | (cp >> 6));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
         }
+        else if (cp < 0x10000) {
+            s += static_cast<char>(0xE0 | (cp >> 12));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else {
+            s += static_cast<char>(0xF0 | (cp >> 18));
+            s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
 
+    // Пропуск значения, отличного от строки; возвращает его исходный текст
+    bool skipValue(string_view& raw) {
+        const char* start = p;
+        int depth = 0;
+        while (p < end) {
+            char c = *p;
+            if (c == '"') {
+                size_t mark = out.decoded.size();
+                string_view ignored;
+                if (!parseString(ignored)) return false;
+                out.decoded.resize(mark);
+                continue;
+            }
+            if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') {
+                if (depth == 0) break;
+                depth--;
+            }
+            else if (c == ',' && depth == 0) break;
+            p++;
+        }
+        if (depth != 0) return false;
+        const char* stop = p;
+        while (stop > start && (stop[-1] == ' ' || stop[-1] == '\n' || stop[-1] == '\r' || stop[-1] == '\t')) stop--;
+        raw = string_view(start, stop - start);
         return true;
     }
-    catch (...) {
-        return false;
+
+    // Ссылка на значение: в исходный текст или на раскодированную строку в
+    // out.decoded, начиная с mark. Повтор уже сохраненной строки откатывается
+    TextRef valueRef(string_view value, size_t mark) {
+        if (out.decoded.size() == mark) return out.sourceRef(value);
+
+        size_t hash = std::hash<string_view>()(value);
+        auto range = interned.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (out.text(it->second) == value) {
+                out.decoded.resize(mark);
+                return it->second;
+            }
+        }
+        TextRef ref{ static_cast<uint32_t>(mark), static_cast<uint32_t>(value.size()) | TextRef::kDecodedBit };
+        interned.emplace(hash, ref);
+        return ref;
     }
-}
 
-string iso2dmy(const string& iso) {
-    if (!validISO(iso)) return "";
-    return iso.substr(8, 2) + "." + iso.substr(5, 2) + "." + iso.substr(0, 4);
-}
+    bool parseObject() {
+        p++;  // '{'
+        TextRef name, iso;
+        bool has_name = false, has_iso = false;
+
+        skipWs();
+        if (p < end && *p == '}') {
+            p++;
+            out.push(name, iso, true);
+            return true;
+        }
+
+        while (true) {
+            skipWs();
+            string_view key, value;
+            size_t mark = out.decoded.size();
+            if (p == end || *p != '"' || !parseString(key)) return false;
+            bool is_name = key == "name", is_iso = key == "date_iso";
+            out.decoded.resize(mark);
+            skipWs();
+            if (p == end || *p != ':') return false;
+            p++;
+            skipWs();
+            if (p == end) return false;
+            if (*p == '"' ? !parseString(value) : !skipValue(value)) return false;
+
+            if (is_name) {
+                name = valueRef(value, mark);
+                has_name = true;
+            }
+            else if (is_iso) {
+                iso = valueRef(value, mark);
+                has_iso = true;
+            }
+            else {
+                out.decoded.resize(mark);
+            }
+
+            skipWs();
+            if (p == end) return false;
+            if (*p == ',') {
+                p++;
+                continue;
+            }
+            if (*p != '}') return false;
+            p++;
+            break;
+        }
+
+        // Пустое значение date_iso — это ошибка формата, а не структуры
+        out.push(name, iso, !has_name || !has_iso);
+        return true;
+    }
+};
+
+// Разбор уже загруженного текста; text должен жить не меньше file
+void parseDates(DateFile& file, string_view text) {
+    file.records.source = text;
+    // Оценка числа записей по размеру файла (~50 байт на запись у генератора)
+    file.records.reserve(text.size() / 48 + 1);
+    DateJsonParser parser(file.records);
+    file.malformed = !parser.parse() || text.size() > UINT32_MAX;
+}
+
+DateFile loadDates(const string& fname) {
+    DateFile file;
+    file.map = MappedFile(fname);
+    if (file.map.data()) parseDates(file, file.map.view());
+    return file;
+}
+
+// ===================== КОНВЕЙЕР ЧТЕНИЯ =====================
+// Отдельный поток читает файлы по порядку в ограниченный набор буферов,
+// рабочие потоки забирают прочитанные файлы, разбирают и проверяют их, а
+// затем возвращают буфер. Пока рабочие заняты разбором, диск (или сеть)
+// уже читает следующие файлы, поэтому время загрузки стремится к
+// max(ввод-вывод, разбор), а не к их сумме. На Linux чтение идет через
+// io_uring сразу по нескольким файлам; без него — блокирующим read().
+
+#ifdef DC_IO_URING
+// Минимальное кольцо io_uring: чтения в заданные буферы и ожидание завершений
+class IoUring {
+    int ring_fd = -1;
+    void* sq_ptr = MAP_FAILED;
+    void* cq_ptr = MAP_FAILED;
+    size_t sq_len = 0, cq_len = 0, sqes_len = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+public:
+    explicit IoUring(unsigned entries) {
+        io_uring_params params{};
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0) return;
+
+        sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_len = cq_len = max(sq_len, cq_len);
+        sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        cq_ptr = single_mmap ? sq_ptr
+            : mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+        if (sq_ptr == MAP_FAILED || cq_ptr == MAP_FAILED || sqes == MAP_FAILED) {
+            release();
+            return;
+        }
+
+        char* sq = static_cast<char*>(sq_ptr);
+        char* cq = static_cast<char*>(cq_ptr);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() { release(); }
+
+    bool ok() const { return ring_fd >= 0; }
+
+    // Чтение len байт файла fd со смещения offset; число одновременных
+    // запросов не должно превышать размер кольца
+    bool submitRead(int fd, char* buf, unsigned len, uint64_t offset, uint64_t user_data) {
+        unsigned tail = *sq_tail;
+        unsigned index = tail & *sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->user_data = user_data;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        return syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0) == 1;
+    }
+
+    // Ожидание одного завершения; res — результат read() или -errno
+    bool wait(uint64_t& user_data, int& res) {
+        while (true) {
+            unsigned head = *cq_head;
+            if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes[head & *cq_mask];
+                user_data = cqe.user_data;
+                res = cqe.res;
+                __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            if (syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+private:
+    void release() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_len);
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_len);
+        if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_len);
+        if (ring_fd >= 0) ::close(ring_fd);
+        sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        sq_ptr = cq_ptr = MAP_FAILED;
+        ring_fd = -1;
+    }
+};
+#endif
+
+// Прочитанный файл, выданный рабочему потоку
+struct PrefetchedFile {
+    size_t index = 0;        // номер в списке файлов
+    int slot = -1;           // буфер конвейера (вернуть через release/take)
+    string_view text;        // пусто, если файл пустой или не прочитан
+};
+
+class FilePrefetcher {
+    struct Slot {
+        unique_ptr<char[]> buf;
+        size_t cap = 0;
+        size_t size = 0;
+        size_t done = 0;
+        int fd = -1;
+        size_t file = 0;
+    };
+
+    const vector<string>& files;
+    vector<Slot> slots;
+    mutex m;
+    condition_variable ready_cv, free_cv;
+    deque<int> ready;
+    deque<int> free_slots;
+    vector<char> slot_ok;
+    size_t delivered = 0;
+    bool stopping = false;
+    atomic<bool> uses_uring{ false };
+    thread reader;
+
+public:
+    // depth — число буферов (файлов в полете и готовых к разбору)
+    FilePrefetcher(const vector<string>& file_list, unsigned depth)
+        : files(file_list), slots(max(1u, depth)), slot_ok(slots.size(), 0) {
+        for (int i = 0; i < static_cast<int>(slots.size()); i++) free_slots.push_back(i);
+        reader = thread([this] { readAll(); });
+    }
+
+    FilePrefetcher(const FilePrefetcher&) = delete;
+    FilePrefetcher& operator=(const FilePrefetcher&) = delete;
+
+    ~FilePrefetcher() {
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        free_cv.notify_all();
+        ready_cv.notify_all();
+        reader.join();
+    }
+
+    bool usesIoUring() const { return uses_uring; }
+
+    // Следующий прочитанный файл (в порядке завершения чтения); false —
+    // все файлы уже выданы
+    bool next(PrefetchedFile& out) {
+        unique_lock<mutex> lock(m);
+        ready_cv.wait(lock, [&] { return !ready.empty() || delivered == files.size() || stopping; });
+        if (ready.empty()) return false;
+        int slot = ready.front();
+        ready.pop_front();
+        delivered++;
+        const Slot& s = slots[slot];
+        out.index = s.file;
+        out.slot = slot;
+        out.text = slot_ok[slot] ? string_view(s.buf.get(), s.size) : string_view();
+        return true;
+    }
+
+    // Буфер больше не нужен и используется для следующих файлов
+    void release(PrefetchedFile& f) {
+        if (f.slot < 0) return;
+        {
+            lock_guard<mutex> lock(m);
+            free_slots.push_back(f.slot);
+        }
+        f.slot = -1;
+        free_cv.notify_one();
+    }
+
+    // Буфер забирает вызывающий (текст остается жить вместе с результатом);
+    // слот получит новый буфер при следующем чтении
+    unique_ptr<char[]> take(PrefetchedFile& f) {
+        unique_ptr<char[]> buf = move(slots[f.slot].buf);
+        slots[f.slot].cap = 0;
+        release(f);
+        return buf;
+    }
+
+private:
+    // Открытие файла и подготовка буфера; false — файл недоступен
+    bool openFile(Slot& s, size_t file) {
+        s.file = file;
+        s.size = s.done = 0;
+#ifdef _WIN32
+        s.fd = _open(files[file].c_str(), _O_RDONLY | _O_BINARY | _O_SEQUENTIAL);
+        if (s.fd < 0) return false;
+        struct _stat64 st;
+        if (_fstat64(s.fd, &st) != 0) return false;
+#else
+        s.fd = ::open(files[file].c_str(), O_RDONLY);
+        if (s.fd < 0) return false;
+        struct stat st;
+        if (fstat(s.fd, &st) != 0) return false;
+#endif
+        s.size = static_cast<size_t>(st.st_size);
+        if (s.size > s.cap) {
+            s.cap = s.size + s.size / 4;
+            s.buf.reset(new char[s.cap]);
+        }
+        return true;
+    }
+
+    void closeFile(Slot& s) {
+        if (s.fd < 0) return;
+#ifdef _WIN32
+        _close(s.fd);
+#else
+        ::close(s.fd);
+#endif
+        s.fd = -1;
+    }
+
+    // Блокирующее чтение остатка файла
+    bool readRest(Slot& s) {
+        while (s.done < s.size) {
+            size_t chunk = min<size_t>(s.size - s.done, 1u << 30);
+#ifdef _WIN32
+            int n = _read(s.fd, s.buf.get() + s.done, static_cast<unsigned>(chunk));
+#else
+            ssize_t n = ::read(s.fd, s.buf.get() + s.done, chunk);
+#endif
+            if (n <= 0) return false;
+            s.done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    void publish(int slot, bool ok) {
+        closeFile(slots[slot]);
+        {
+            lock_guard<mutex> lock(m);
+            slot_ok[slot] = ok;
+            ready.push_back(slot);
+        }
+        ready_cv.notify_one();
+    }
+
+    // Свободный буфер; -1 — конвейер останавливается
+    int acquireSlot(bool wait) {
+        unique_lock<mutex> lock(m);
+        if (wait) free_cv.wait(lock, [&] { return !free_slots.empty() || stopping; });
+        if (stopping || free_slots.empty()) return -1;
+        int slot = free_slots.front();
+        free_slots.pop_front();
+        return slot;
+    }
+
+    void readAll() {
+        size_t next_file = 0;
+#ifdef DC_IO_URING
+        IoUring ring(static_cast<unsigned>(slots.size()));
+        uses_uring = ring.ok();
+        size_t in_flight = 0;
+        while (uses_uring && (next_file < files.size() || in_flight > 0)) {
+            // Запросы на чтение для всех свободных буферов
+            while (next_file < files.size()) {
+                int slot = acquireSlot(in_flight == 0);
+                if (slot < 0) break;
+                Slot& s = slots[slot];
+                if (!openFile(s, next_file++)) {
+                    publish(slot, false);
+                }
+                else if (s.size == 0) {
+                    publish(slot, true);
+                }
+                else if (ring.submitRead(s.fd, s.buf.get(), static_cast<unsigned>(min<size_t>(s.size, 1u << 30)), 0,
+                    static_cast<uint64_t>(slot))) {
+                    in_flight++;
+                }
+                else {
+                    publish(slot, readRest(s));
+                }
+            }
+            if (in_flight == 0) {
+                lock_guard<mutex> lock(m);
+                if (stopping) return;
+                continue;
+            }
+
+            uint64_t user_data;
+            int res;
+            if (!ring.wait(user_data, res)) {
+                uses_uring = false;
+                break;
+            }
+            int slot = static_cast<int>(user_data);
+            Slot& s = slots[slot];
+            in_flight--;
+            if (res == -EINVAL || res == -EOPNOTSUPP) {
+                // Ядро без IORING_OP_READ: дочитываем этот файл обычным read()
+                publish(slot, readRest(s));
+                uses_uring = false;
+                continue;
+            }
+            if (res > 0) s.done += static_cast<size_t>(res);
+            if (res > 0 && s.done < s.size &&
+                ring.submitRead(s.fd, s.buf.get() + s.done, static_cast<unsigned>(min<size_t>(s.size - s.done, 1u << 30)),
+                    s.done, user_data)) {
+                in_flight++;
+                continue;
+            }
+            publish(slot, s.done == s.size || readRest(s));
+        }
+        if (in_flight > 0) {
+            // Кольцо отказало на ожидании: оставшиеся файлы читаются заново
+            for (auto& s : slots) {
+                if (s.fd < 0) continue;
+                int slot = static_cast<int>(&s - slots.data());
+                s.done = 0;
+                lseek(s.fd, 0, SEEK_SET);
+                publish(slot, readRest(s));
+            }
+        }
+#endif
+        while (next_file < files.size()) {
+            int slot = acquireSlot(true);
+            if (slot < 0) return;
+            Slot& s = slots[slot];
+            bool ok = openFile(s, next_file++) && readRest(s);
+            publish(slot, ok);
+        }
+    }
+};
+
+// Глубина конвейера: по два буфера на рабочий поток
+inline unsigned prefetchDepth(unsigned workers) {
+    return max(4u, workers * 2);
+}
+
+// Разбор выданного конвейером файла; пустой или недоступный файл дает
+// пустой набор без признака повреждения, как и loadDates
+DateFile parsePrefetched(const PrefetchedFile& f) {
+    DateFile file;
+    if (!f.text.empty()) parseDates(file, f.text);
+    return file;
+}
+
+// ===================== ПОТОКОВАЯ ЗАГРУЗКА =====================
+// Файл, который не нужно держать в памяти целиком, читается окном
+// фиксированного размера. Из окна выделяются целые объекты верхнего уровня,
+// они разбираются в пакет, а незаконченный объект переносится в начало окна
+// перед следующим чтением. Память не зависит от размера файла: окно растет,
+// только если одна запись длиннее его.
+
+// Файлы не меньше этого размера analyze и convert обрабатывают потоково
+const unsigned long long kStreamMinFileSize = 256ull << 20;
+// Окно чтения потокового режима
+const size_t kStreamWindow = 4u << 20;
+
+class DateStream {
+    static const size_t npos = static_cast<size_t>(-1);
+
+    int fd = -1;
+    unique_ptr<char[]> buf;
+    size_t cap;
+    size_t len = 0;              // байт в окне
+    size_t pos = 0;              // начало неразобранной части окна
+    unsigned long long consumed = 0;
+    bool eof = false;
+    bool started = false;        // BOM и '[' уже пропущены
+    bool in_array = false;
+    bool any = false;            // в массиве уже был объект
+    bool expect_value = true;    // ждем объект, а не разделитель
+    bool finished = false;
+    bool bad = false;
+
+public:
+    explicit DateStream(const string& fname, size_t window = kStreamWindow) : cap(max<size_t>(window, 64)) {
+#ifdef _WIN32
+        fd = _open(fname.c_str(), _O_RDONLY | _O_BINARY | _O_SEQUENTIAL);
+#else
+        fd = ::open(fname.c_str(), O_RDONLY);
+#endif
+        if (fd >= 0) buf.reset(new char[cap]);
+    }
+
+    DateStream(const DateStream&) = delete;
+    DateStream& operator=(const DateStream&) = delete;
+
+    ~DateStream() {
+        if (fd < 0) return;
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    bool ok() const { return fd >= 0; }
+    // Нарушена структура JSON; записи до места ошибки уже выданы
+    bool malformed() const { return bad; }
+    // Разобрано байт файла
+    unsigned long long bytesParsed() const { return consumed; }
+
+    // Следующий пакет записей; batch очищается и ссылается в окно до
+    // следующего вызова. false — записей больше нет
+    bool next(DateBatch& batch) {
+        batch.clear();
+        while (ok() && !bad && !finished) {
+            refill();
+            if (!started && !start()) {
+                if (eof) break;
+                continue;
+            }
+            size_t cut = scan();
+            if (cut > pos) {
+                batch.source = string_view(buf.get() + pos, cut - pos);
+                batch.reserve((cut - pos) / 48 + 1);
+                DateJsonParser parser(batch);
+                bad = !parser.parse();
+                advance(cut);
+                if (!batch.empty()) return true;
+                continue;
+            }
+            if (finished) break;
+            if (eof) {
+                // После последнего объекта допустимы только пробелы и ']'
+                size_t q = skipWs(pos);
+                bad = q < len || in_array;
+                break;
+            }
+            if (pos == 0 && len == cap) {
+                // Одна запись длиннее окна
+                unique_ptr<char[]> bigger(new char[cap * 2]);
+                memcpy(bigger.get(), buf.get(), len);
+                buf = move(bigger);
+                cap *= 2;
+            }
+        }
+        return false;
+    }
+
+private:
+    void advance(size_t to) {
+        consumed += to - pos;
+        pos = to;
+    }
+
+    size_t skipWs(size_t q) const {
+        const char* b = buf.get();
+        while (q < len && (b[q] == ' ' || b[q] == '\n' || b[q] == '\r' || b[q] == '\t')) q++;
+        return q;
+    }
+
+    // Сдвиг остатка в начало окна и чтение до заполнения
+    void refill() {
+        if (pos > 0) {
+            memmove(buf.get(), buf.get() + pos, len - pos);
+            len -= pos;
+            pos = 0;
+        }
+        while (!eof && len < cap) {
+#ifdef _WIN32
+            int n = _read(fd, buf.get() + len, static_cast<unsigned>(min<size_t>(cap - len, 1u << 30)));
+#else
+            ssize_t n = ::read(fd, buf.get() + len, cap - len);
+#endif
+            if (n <= 0) eof = true;
+            else len += static_cast<size_t>(n);
+        }
+    }
+
+    // BOM, пробелы и '[' в начале файла; false — данных пока мало
+    bool start() {
+        size_t q = pos;
+        if (consumed == 0 && len >= 3 && memcmp(buf.get(), "\xEF\xBB\xBF", 3) == 0) q = 3;
+        q = skipWs(q);
+        if (q == len) {
+            advance(q);
+            if (eof) finished = true;  // пустой файл — не ошибка, как в parse()
+            return false;
+        }
+        in_array = buf[q] == '[';
+        if (in_array) q++;
+        advance(q);
+        started = true;
+        return true;
+    }
+
+    // Конец объекта, начинающегося в q ('{'), или npos, если он не целиком в окне
+    size_t objectEnd(size_t q) const {
+        const char* b = buf.get();
+        int depth = 0;
+        while (q < len) {
+            char c = b[q++];
+            if (c == '"') {
+                // Закрывающая кавычка — та, перед которой четное число '\\'
+                while (true) {
+                    const char* quote = static_cast<const char*>(memchr(b + q, '"', len - q));
+                    if (!quote) return npos;
+                    size_t k = static_cast<size_t>(quote - b), slashes = 0;
+                    while (b[k - 1 - slashes] == '\\') slashes++;
+                    q = k + 1;
+                    if (slashes % 2 == 0) break;
+                }
+            }
+            else if (c == '{' || c == '[') {
+                depth++;
+            }
+            else if ((c == '}' || c == ']') && --depth == 0) {
+                return q;
+            }
+        }
+        return npos;
+    }
+
+    // Граница последнего целого объекта в окне (вместе с запятой после него,
+    // если она уже прочитана). Запятая в начале окна пропускается сразу:
+    // разбор куска всегда начинается с объекта
+    size_t scan() {
+        size_t cut = pos;
+        size_t q = skipWs(pos);
+        while (q < len) {
+            char c = buf[q];
+            if (!expect_value && c == ',') {
+                expect_value = true;
+                if (cut == pos) advance(q + 1);
+                cut = q + 1;
+            }
+            else if (in_array && c == ']' && (!expect_value || !any)) {
+                finished = true;
+                break;
+            }
+            else if (c == '{' && (expect_value || !in_array)) {
+                size_t e = objectEnd(q);
+                if (e == npos) break;
+                cut = q = e;
+                expect_value = false;
+                any = true;
+                q = skipWs(q);
+                continue;
+            }
+            else {
+                bad = true;
+                break;
+            }
+            q = skipWs(q + 1);
+        }
+        return cut;
+    }
+};
+
+// ===================== ПУЛ ПОТОКОВ =====================
+// Пул с перехватом работы: индексы задач заранее делятся на непрерывные
+// блоки по очередям потоков, поток берет задачи из начала своей очереди,
+// а опустев — забирает из конца чужой. Вызывающий поток работает как поток 0.
+
+class WorkStealingPool {
+    struct alignas(64) Queue {
+        mutex m;
+        deque<size_t> items;
+    };
+
+    using Task = function<void(size_t index, unsigned worker)>;
+
+    vector<thread> threads;
+    vector<unique_ptr<Queue>> queues;
+
+    // Задание у пула одно: внешние вызовы parallelFor из разных потоков
+    // (демон, пакетный режим) выполняются по очереди
+    mutex call_mutex;
+
+    mutex job_mutex;
+    condition_variable job_cv, done_cv;
+    const Task* job = nullptr;
+    uint64_t job_generation = 0;
+    unsigned active = 0;
+    bool stopping = false;
+
+    mutex error_mutex;
+    exception_ptr error;
+
+    // Поток выполняет задачу пула: вложенный parallelFor идет в нем же
+    static inline thread_local bool in_task = false;
+
+public:
+    explicit WorkStealingPool(unsigned thread_count) {
+        thread_count = max(1u, thread_count);
+        for (unsigned i = 0; i < thread_count; i++) queues.push_back(make_unique<Queue>());
+        for (unsigned i = 1; i < thread_count; i++) threads.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lk(job_mutex);
+            stopping = true;
+        }
+        job_cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    // Выполняет task(index, worker) для всех index из [0, n) и ждет завершения.
+    // worker < size() — номер потока, для счетчиков без разделяемых данных.
+    // Вызов из задачи пула выполняется последовательно в том же потоке,
+    // одновременные вызовы из других потоков ждут друг друга
+    void parallelFor(size_t n, const Task& task) {
+        if (n == 0) return;
+        if (queues.size() == 1 || n == 1 || in_task) {
+            for (size_t i = 0; i < n; i++) task(i, 0);
+            return;
+        }
+
+        lock_guard<mutex> call(call_mutex);
+
+        size_t workers = queues.size();
+        for (size_t w = 0; w < workers; w++) {
+            lock_guard<mutex> lk(queues[w]->m);
+            for (size_t i = n * w / workers; i < n * (w + 1) / workers; i++) queues[w]->items.push_back(i);
+        }
+
+        {
+            lock_guard<mutex> lk(job_mutex);
+            job = &task;
+            active = static_cast<unsigned>(threads.size());
+            job_generation++;
+        }
+        job_cv.notify_all();
+
+        runTasks(0, task);
+
+        {
+            unique_lock<mutex> lk(job_mutex);
+            done_cv.wait(lk, [this] { return active == 0; });
+            job = nullptr;
+        }
+
+        if (error) {
+            exception_ptr e = error;
+            error = nullptr;
+            rethrow_exception(e);
+        }
+    }
+
+private:
+    void workerLoop(unsigned id) {
+        uint64_t seen = 0;
+        while (true) {
+            unique_lock<mutex> lk(job_mutex);
+            job_cv.wait(lk, [&] { return stopping || job_generation != seen; });
+            if (stopping) return;
+            seen = job_generation;
+            const Task* task = job;
+            lk.unlock();
+
+            runTasks(id, *task);
+
+            lk.lock();
+            if (--active == 0) done_cv.notify_all();
+        }
+    }
+
+    bool popOwn(unsigned id, size_t& index) {
+        Queue& q = *queues[id];
+        lock_guard<mutex> lk(q.m);
+        if (q.items.empty()) return false;
+        index = q.items.front();
+        q.items.pop_front();
+        return true;
+    }
+
+    bool steal(unsigned id, size_t& index) {
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue& q = *queues[(id + k) % queues.size()];
+            lock_guard<mutex> lk(q.m);
+            if (q.items.empty()) continue;
+            index = q.items.back();
+            q.items.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    // Очереди заполняются только до старта, поэтому пустота всех очередей
+    // означает, что новых задач не будет
+    void runTasks(unsigned id, const Task& task) {
+        size_t index;
+        in_task = true;
+        while (popOwn(id, index) || steal(id, index)) {
+            try {
+                task(index, id);
+            }
+            catch (...) {
+                lock_guard<mutex> lk(error_mutex);
+                if (!error) error = current_exception();
+            }
+        }
+        in_task = false;
+    }
+};
+
+// Число потоков обработки (0 — по числу ядер); задается до первого вызова sharedPool()
+unsigned worker_threads = 0;
+
+WorkStealingPool& sharedPool() {
+    static WorkStealingPool pool(worker_threads ? worker_threads : max(1u, thread::hardware_concurrency()));
+    return pool;
+}
+
+// Счетчики одного потока на отдельной кэш-линии (без ложного разделения)
+template <typename T>
+struct alignas(64) PerThread {
+    T value;
+};
+
+// ===================== ГИСТОГРАММА ЗАДЕРЖЕК =====================
+// Логарифмические корзины в духе HDR Histogram: значения до 2^kSubBits хранятся
+// точно, дальше каждая степень двойки делится на 2^kSubBits корзин, т.е.
+// относительная погрешность квантиля не больше 1/32. Память фиксирована
+// (~15 КБ) и не зависит от числа измерений; сортировка не нужна.
+
+class LatencyHistogram {
+    static const int kSubBits = 5;
+    static const int kSubCount = 1 << kSubBits;
+    static const int kBucketCount = (64 - kSubBits + 1) * kSubCount;
+
+    array<uint64_t, kBucketCount> buckets{};
+    uint64_t total = 0;
+    uint64_t min_value = UINT64_MAX;
+    uint64_t max_value = 0;
+    double sum = 0;
+    double sum_sq = 0;
+
+    static int highestBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(v);
+#else
+        int bit = 0;
+        while (v >>= 1) bit++;
+        return bit;
+#endif
+    }
+
+    static int bucketIndex(uint64_t v) {
+        if (v < kSubCount) return static_cast<int>(v);
+        int shift = highestBit(v) - kSubBits;
+        return (shift + 1) * kSubCount + static_cast<int>((v >> shift) - kSubCount);
+    }
+
+    // Середина диапазона значений корзины
+    static uint64_t bucketValue(int index) {
+        if (index < kSubCount) return static_cast<uint64_t>(index);
+        int shift = index / kSubCount - 1;
+        uint64_t low = static_cast<uint64_t>(index % kSubCount + kSubCount) << shift;
+        return low + ((uint64_t(1) << shift) >> 1);
+    }
+
+public:
+    // Значение, встретившееся count раз
+    void record(uint64_t value, uint64_t count = 1) {
+        if (count == 0) return;
+        buckets[bucketIndex(value)] += count;
+        total += count;
+        min_value = min(min_value, value);
+        max_value = max(max_value, value);
+        sum += static_cast<double>(value) * count;
+        sum_sq += static_cast<double>(value) * value * count;
+    }
+
+    void merge(const LatencyHistogram& o) {
+        for (int i = 0; i < kBucketCount; i++) buckets[i] += o.buckets[i];
+        total += o.total;
+        min_value = min(min_value, o.min_value);
+        max_value = max(max_value, o.max_value);
+        sum += o.sum;
+        sum_sq += o.sum_sq;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t minimum() const { return total ? min_value : 0; }
+    uint64_t maximum() const { return max_value; }
+    double mean() const { return total ? sum / total : 0; }
+
+    double stddev() const {
+        if (!total) return 0;
+        double m = mean();
+        return sqrt(max(0.0, sum_sq / total - m * m));
+    }
+
+    // Квантиль q из [0, 1]; точные min и max для крайних значений
+    uint64_t percentile(double q) const {
+        if (!total) return 0;
+        uint64_t rank = static_cast<uint64_t>(ceil(q * total));
+        if (rank == 0) return minimum();
+        if (rank >= total) return max_value;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; i++) {
+            seen += buckets[i];
+            if (seen >= rank) return clamp(bucketValue(i), min_value, max_value);
+        }
+        return max_value;
+    }
+
+    // Число измерений, заведомо больших threshold (с точностью до корзины)
+    uint64_t countAbove(double threshold) const {
+        uint64_t n = 0;
+        for (int i = kBucketCount - 1; i >= 0 && static_cast<double>(bucketValue(i)) > threshold; i--) {
+            n += buckets[i];
+        }
+        return n;
+    }
+};
+
+// Статистика задержек: квантили и аномалии (дальше 3 стандартных отклонений
+// от среднего). Значения в наносекундах, вывод в микросекундах
+void reportLatency(ReportSink& report, const char* key, const string& title, const LatencyHistogram& h) {
+    if (h.count() == 0) return;
+    double threshold = h.mean() + 3 * h.stddev();
+    auto us = [](double ns) { return ns / 1000.0; };
+
+    report.section(key, title);
+    report.count("count", "Измерений:", static_cast<long long>(h.count()));
+    report.number("min_us", "Минимальное время:", us(h.minimum()), " мкс");
+    report.number("p50_us", "Медиана (p50):", us(h.percentile(0.5)), " мкс");
+    report.number("p90_us", "p90:", us(h.percentile(0.9)), " мкс");
+    report.number("p99_us", "p99:", us(h.percentile(0.99)), " мкс");
+    report.number("p999_us", "p99.9:", us(h.percentile(0.999)), " мкс");
+    report.number("max_us", "Максимальное время:", us(h.maximum()), " мкс");
+    report.number("mean_us", "Среднее время:", us(h.mean()), " мкс");
+    report.count("anomalies", "Найдено аномалий:", static_cast<long long>(h.countAbove(threshold)));
+    report.number("anomaly_threshold_us", "Порог аномалий:", us(threshold), " мкс");
+    report.end_section();
+}
+
+// ===================== ГЕНЕРАТОР КОРПУСА =====================
+// Файлы генерируются параллельно. Поток случайных чисел выводится из
+// (seed, номер файла), поэтому один и тот же seed дает побайтно одинаковые
+// файлы при любом числе потоков и на любой платформе.
+
+// Генератор SplitMix64: быстрый и с собственной (не зависящей от STL) выборкой
+struct SplitMix64 {
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Равномерно в [0, range) умножением вместо деления
+    uint32_t below(uint32_t range) {
+        return static_cast<uint32_t>(((next() >> 32) * range) >> 32);
+    }
+};
+
+// Виды ошибок генератора в порядке категорий DateError (WrongSeparator..MissingField)
+const int kGeneratorErrorKinds = 8;
+// Входные форматы корректных дат: ISO, DD.MM.YYYY, MM/DD/YYYY, «30 ноября 2025»
+const int kGeneratorFormats = 4;
+const char* const kGeneratorFormatNames[kGeneratorFormats] = { "iso", "dmy", "mdy", "text" };
+
+// Значения date_iso для видов ошибок генератора
+const char* const kGeneratorBadDates[kGeneratorErrorKinds] = {
+    "2024/12/31",        // неправильный разделитель
+    "31-12-2024",        // европейский формат
+    "2024-13-45",        // несуществующий месяц/день
+    "abcd-ef-gh",        // некорректные символы
+    "2024-12",           // неполная дата
+    "",                  // пустая строка
+    "2024-12-31-extra",  // лишние символы
+    nullptr              // пропущенное поле date_iso
+};
+
+struct GeneratorConfig {
+    int files = 10;
+    int records_per_file = 10;
+    int error_percent = 30;
+    // Относительные веса видов ошибок; по умолчанию как в исходном генераторе,
+    // где неверный разделитель и порядок полей выпадали вдвое чаще
+    array<unsigned, kGeneratorErrorKinds> error_weights = { 2, 2, 1, 1, 1, 1, 1, 1 };
+    // Относительные веса форматов корректных дат; по умолчанию только ISO
+    array<unsigned, kGeneratorFormats> format_weights = { 1, 0, 0, 0 };
+    uint64_t seed = 0;
+    string out_dir;
+};
+
+// Итог генерации
+struct GenerateStats {
+    int correct_files = 0;
+    int error_files = 0;
+    long long records = 0;
+    long long error_records = 0;
+    long long bytes = 0;
+};
+
+// Десятичная запись числа; возвращает указатель за последней цифрой
+inline char* writeUInt(char* p, unsigned v) {
+    char tmp[10];
+    int len = 0;
+    do {
+        tmp[len++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (len) *p++ = tmp[--len];
+    return p;
+}
+
+// Одна сгенерированная запись: вид ошибки (-1 — корректная) или дата и ее формат
+struct GeneratedRecord {
+    int error_kind;
+    int y, m, d;
+    int format;
+};
+
+GeneratedRecord drawRecord(const GeneratorConfig& cfg, unsigned weight_sum, SplitMix64& rng) {
+    GeneratedRecord rec = { -1, 0, 0, 0, 0 };
+    if (weight_sum > 0 && rng.below(100) < static_cast<uint32_t>(cfg.error_percent)) {
+        unsigned r = rng.below(weight_sum);
+        int kind = 0;
+        while (r >= cfg.error_weights[kind]) r -= cfg.error_weights[kind++];
+        rec.error_kind = kind;
+        return rec;
+    }
+
+    static const int days_in_month[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    rec.y = 2000 + static_cast<int>(rng.below(25));
+    rec.m = 1 + static_cast<int>(rng.below(12));
+    bool isLeap = (rec.y % 4 == 0 && rec.y % 100 != 0) || (rec.y % 400 == 0);
+    rec.d = 1 + static_cast<int>(rng.below(days_in_month[rec.m - 1] + (rec.m == 2 && isLeap)));
+
+    // Формат выбирается, только если заданы не-ISO веса: корпус только из ISO
+    // с тем же seed остается побайтно прежним
+    unsigned other_formats = 0, format_sum = 0;
+    for (int f = 0; f < kGeneratorFormats; f++) {
+        format_sum += cfg.format_weights[f];
+        if (f > 0) other_formats += cfg.format_weights[f];
+    }
+    if (other_formats > 0) {
+        unsigned r = rng.below(format_sum);
+        while (rec.format + 1 < kGeneratorFormats && r >= cfg.format_weights[rec.format]) {
+            r -= cfg.format_weights[rec.format++];
+        }
+    }
+    return rec;
+}
+
+// Корректная дата записи в ее формате; возвращает длину
+size_t writeGeneratedDate(const GeneratedRecord& rec, char* out) {
+    switch (rec.format) {
+    case 1:
+    case 2: {
+        char sep = rec.format == 1 ? '.' : '/';
+        writeDigits(out, rec.format == 1 ? rec.d : rec.m, 2);
+        out[2] = sep;
+        writeDigits(out + 3, rec.format == 1 ? rec.m : rec.d, 2);
+        out[5] = sep;
+        writeDigits(out + 6, rec.y, 4);
+        return 10;
+    }
+    case 3: {
+        char* p = writeUInt(out, static_cast<unsigned>(rec.d));
+        *p++ = ' ';
+        size_t len = strlen(kMonthNames[rec.m - 1]);
+        memcpy(p, kMonthNames[rec.m - 1], len);
+        p += len;
+        *p++ = ' ';
+        writeDigits(p, rec.y, 4);
+        return static_cast<size_t>(p + 4 - out);
+    }
+    default:
+        writeDigits(out, rec.y, 4);
+        out[4] = '-';
+        writeDigits(out + 5, rec.m, 2);
+        out[7] = '-';
+        writeDigits(out + 8, rec.d, 2);
+        return 10;
+    }
+}
+
+// Запись одного файла через потоковый writer. Имя файла зависит от наличия
+// ошибок, поэтому сначала выполняется холостой проход по копии генератора
+// (только случайные числа), затем файл пишется потоково без накопления в памяти.
+// Возвращает число записей с ошибками или -1 при ошибке записи
+int writeGeneratedFile(const GeneratorConfig& cfg, int file_index, SplitMix64 rng, simple_json::writer& out) {
+    unsigned weight_sum = 0;
+    for (unsigned w : cfg.error_weights) weight_sum += w;
+
+    SplitMix64 dry = rng;
+    int error_count = 0;
+    for (int j = 0; j < cfg.records_per_file; j++) {
+        error_count += drawRecord(cfg, weight_sum, dry).error_kind >= 0;
+    }
+
+    string filename = (error_count ? "mixed_data_" : "correct_data_") + to_string(file_index) + ".json";
+    if (!out.open(cfg.out_dir.empty() ? filename : (fs::path(cfg.out_dir) / filename).string())) return -1;
+
+    // Имена собираются в локальном буфере "error_record_<файл>_<запись>";
+    // для корректных записей берется суффикс без "error_"
+    char name[48];
+    memcpy(name, "error_record_", 13);
+    char* name_tail = writeUInt(name + 13, static_cast<unsigned>(file_index));
+    *name_tail++ = '_';
+    char date[32];
+
+    out.begin_array();
+    for (int j = 0; j < cfg.records_per_file; j++) {
+        GeneratedRecord rec = drawRecord(cfg, weight_sum, rng);
+        bool is_error = rec.error_kind >= 0;
+        char* name_end = writeUInt(name_tail, static_cast<unsigned>(j));
+        const char* name_begin = is_error ? name : name + 6;
+
+        out.begin_object();
+        out.field("name", string_view(name_begin, name_end - name_begin));
+        if (!is_error) {
+            out.field("date_iso", string_view(date, writeGeneratedDate(rec, date)));
+        }
+        else if (kGeneratorBadDates[rec.error_kind]) {
+            out.field("date_iso", kGeneratorBadDates[rec.error_kind]);
+        }
+        out.end_object();
+    }
+    out.end_array();
+    return out.close() ? error_count : -1;
+}
+
+// files_report — строка на каждый файл (в порядке номеров файлов)
+GenerateStats generateCorpus(const GeneratorConfig& cfg, ReportSink* files_report = nullptr) {
+    WorkStealingPool& pool = sharedPool();
+    vector<unique_ptr<simple_json::writer>> writers(pool.size());
+    vector<int> file_errors(max(cfg.files, 0), -1);  // -1 — файл не записан
+    vector<unsigned long long> file_bytes(file_errors.size(), 0);
+
+    pool.parallelFor(file_errors.size(), [&](size_t i, unsigned worker) {
+        if (!writers[worker]) writers[worker] = make_unique<simple_json::writer>(256 * 1024);
+        SplitMix64 rng(SplitMix64(cfg.seed ^ (0xD1B54A32D192ED03ull * (i + 1))).next());
+        file_errors[i] = writeGeneratedFile(cfg, static_cast<int>(i), rng, *writers[worker]);
+        file_bytes[i] = writers[worker]->bytes();
+    });
+
+    GenerateStats st;
+    for (size_t i = 0; i < file_errors.size(); i++) {
+        int error_count = file_errors[i];
+        if (error_count < 0) continue;
+        if (error_count) st.error_files++;
+        else st.correct_files++;
+        st.records += cfg.records_per_file;
+        st.error_records += error_count;
+        st.bytes += file_bytes[i];
+
+        if (files_report) {
+            string filename = (error_count ? "mixed_data_" : "correct_data_") + to_string(i) + ".json";
+            string file_type = error_count ? "СМЕШАННЫЙ (ошибок: " + to_string(error_count) + ")" : "КОРРЕКТНЫЙ";
+            files_report->note("Создан " + file_type + " файл: " + filename + " (корректных: " +
+                to_string(cfg.records_per_file - error_count) + ", ошибок: " + to_string(error_count) + ")");
+        }
+    }
+
+    return st;
+}
+
+// Итог генерации; поля в порядке строки пакетного режима
+void reportGenerate(ReportSink& report, const GeneratorConfig& cfg, const GenerateStats& st, long long time_ms) {
+    report.section("summary", "СВОДКА ГЕНЕРАЦИИ");
+    report.count("files", "Всего создано файлов:", cfg.files);
+    report.count("correct", "Корректных файлов:", st.correct_files);
+    report.count("mixed", "Файлов с ошибками:", st.error_files);
+    report.count("records", "Записей:", st.records);
+    report.count("error_records", "Записей с ошибками:", st.error_records);
+    report.count("bytes", "Байт:", st.bytes);
+    report.text("seed", "Seed:", to_string(cfg.seed));
+    report.count("time_ms", "Время:", time_ms, " мс");
+    report.end_section();
+}
+
+// Случайный seed для интерактивного режима (выводится в сводке для повтора)
+uint64_t randomSeed() {
+    random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+// out_dir — каталог для файлов (пусто = текущий), report — куда вывести итог
+// (строки по файлам — только при report_files)
+GenerateStats generateMixedFiles(int n, int error_percentage = 30, const string& out_dir = "", ReportSink* report = nullptr) {
+    GeneratorConfig cfg;
+    cfg.files = n;
+    cfg.error_percent = error_percentage;
+    cfg.out_dir = out_dir;
+    cfg.seed = randomSeed();
+    auto start = chrono::high_resolution_clock::now();
+    if (report) report->begin("generate", "");
+    GenerateStats st = generateCorpus(cfg, report && report_files ? report : nullptr);
+    if (report) {
+        auto end = chrono::high_resolution_clock::now();
+        reportGenerate(*report, cfg, st, chrono::duration_cast<chrono::milliseconds>(end - start).count());
+        report->end();
+    }
+    return st;
+}
+
+// Итог конвертации набора записей
+struct ConvertStats {
+    long long converted = 0;
+    long long errors = 0;
+    ErrorCounts error_kinds;
+
+    void merge(const ConvertStats& o) {
+        converted += o.converted;
+        errors += o.errors;
+        error_kinds.merge(o.error_kinds);
+    }
+};
+
+// Пакетная проверка записей [from, to): даты вида ????-... длиной 10 символов
+// упаковываются в плотный буфер и проходят через SIMD-ядро, остальные
+// (DD.MM.YYYY, MM/DD/YYYY, название месяца, ошибки) сразу идут в parseDate —
+// формат различается по одному байту еще при упаковке. Заполняет столбцы errors и ordinals; записи без полей
+// (MissingField с загрузки) не трогает. Даты в выходных форматах строятся
+// позже, при записи. Буферы упаковки свои у каждого потока
+ConvertStats convertRecordsBatch(DateBatch& batch, size_t from, size_t to) {
+    static thread_local vector<size_t> packed_idx;
+    static thread_local string packed;
+    static thread_local vector<DateError> errs;
+    static thread_local vector<int32_t> days;
+    packed_idx.clear();
+    packed.clear();
+
+    for (size_t i = from; i < to; i++) {
+        if (batch.errors[i] == DateError::MissingField) continue;
+        string_view iso = batch.iso(i);
+        if (iso.size() == 10 && iso[4] == '-') {
+            packed_idx.push_back(i);
+            packed.append(iso.data(), 10);
+        }
+        else {
+            batch.errors[i] = parseDate(iso, batch.ordinals[i]);
+        }
+    }
+
+    errs.resize(packed_idx.size());
+    days.resize(packed_idx.size());
+    convertPackedISO(packed.data(), packed_idx.size(), nullptr, nullptr, errs.data(), days.data());
+    for (size_t k = 0; k < packed_idx.size(); k++) {
+        batch.errors[packed_idx[k]] = errs[k];
+        batch.ordinals[packed_idx[k]] = days[k];
+    }
+
+    ConvertStats st;
+    for (size_t i = from; i < to; i++) {
+        if (batch.errors[i] == DateError::None) {
+            st.converted++;
+        }
+        else {
+            st.errors++;
+            st.error_kinds.add(batch.errors[i]);
+        }
+    }
+    return st;
+}
+
+// Шаг выборки задержек: время измеряется у каждой kLatencySample-й записи
+const size_t kLatencySample = 256;
+
+// Проверка загруженных записей без консольного ввода/вывода.
+// latency — необязательный сбор задержек: каждая kLatencySample-я запись
+// проверяется отдельно, и ее время (вместе с вызовом часов) попадает в
+// гистограмму; записи между ними идут пакетом без замеров. Квантили — по
+// настоящим задержкам записей, а не по средним за пакет
+ConvertStats convertRecordsRange(DateBatch& batch, size_t from, size_t to, LatencyHistogram* latency) {
+    if (!latency) return convertRecordsBatch(batch, from, to);
+
+    ConvertStats st;
+    for (; from < to; from += kLatencySample) {
+        auto start = chrono::high_resolution_clock::now();
+        st.merge(convertRecordsBatch(batch, from, from + 1));
+        auto end = chrono::high_resolution_clock::now();
+        latency->record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(end - start).count()));
+        size_t stop = min(to, from + kLatencySample);
+        if (from + 1 < stop) st.merge(convertRecordsBatch(batch, from + 1, stop));
+    }
+    return st;
+}
+
+ConvertStats convertRecords(DateBatch& batch, LatencyHistogram* latency = nullptr) {
+    return convertRecordsRange(batch, 0, batch.size(), latency);
+}
+
+// Записей в части файла при параллельной проверке: столбцы части (~20 байт
+// на запись) и ее текст помещаются в L2 одного ядра
+const size_t kConvertChunk = 16384;
+static_assert(kConvertChunk % kLatencySample == 0, "выборка задержек не зависит от деления на части");
+
+// Проверка одного крупного набора записей всеми потоками пула: записи делятся
+// на части по kConvertChunk, каждая часть пишет только свои элементы столбцов
+// errors и ordinals, поэтому порядок записей не меняется, а итоги частей
+// складываются после. Небольшой набор (или вызов из задачи пула) проверяется
+// последовательно
+ConvertStats convertRecordsParallel(DateBatch& batch, LatencyHistogram* latency = nullptr) {
+    WorkStealingPool& pool = sharedPool();
+    size_t chunks = (batch.size() + kConvertChunk - 1) / kConvertChunk;
+    if (pool.size() == 1 || chunks < 2) return convertRecords(batch, latency);
+
+    vector<ConvertStats> partial(chunks);
+    vector<PerThread<LatencyHistogram>> chunk_latency(latency ? pool.size() : 0);
+    pool.parallelFor(chunks, [&](size_t c, unsigned worker) {
+        size_t from = c * kConvertChunk;
+        partial[c] = convertRecordsRange(batch, from, min(batch.size(), from + kConvertChunk),
+            latency ? &chunk_latency[worker].value : nullptr);
+    });
+
+    ConvertStats st;
+    for (const auto& p : partial) st.merge(p);
+    for (const auto& l : chunk_latency) latency->merge(l.value);
+    return st;
+}
+
+// Обработка прочитанных файлов: по файлу на задачу пула, а если файлов
+// меньше, чем потоков, — по очереди в вызывающем потоке, чтобы проверку
+// внутри каждого файла (convertRecordsParallel) выполняли все потоки
+template <typename Task>
+void forEachFile(WorkStealingPool& pool, size_t files, const Task& task) {
+    if (files >= pool.size()) {
+        pool.parallelFor(files, task);
+        return;
+    }
+    for (size_t i = 0; i < files; i++) task(i, 0u);
+}
+
+// Формат выгрузки результатов конвертации
+enum class ExportFormat { Json, Ndjson, Csv };
+
+bool parseExportFormat(const string& name, ExportFormat& format) {
+    if (name == "json") format = ExportFormat::Json;
+    else if (name == "ndjson") format = ExportFormat::Ndjson;
+    else if (name == "csv") format = ExportFormat::Csv;
+    else return false;
+    return true;
+}
+
+const char* exportExtension(ExportFormat format) {
+    switch (format) {
+    case ExportFormat::Ndjson: return ".ndjson";
+    case ExportFormat::Csv: return ".csv";
+    default: return ".json";
+    }
+}
+
+// Формат по расширению имени файла; неизвестное расширение — JSON
+ExportFormat exportFormatForPath(const string& path) {
+    string ext = fs::path(path).extension().string();
+    if (ext == ".csv") return ExportFormat::Csv;
+    if (ext == ".ndjson" || ext == ".jsonl") return ExportFormat::Ndjson;
+    return ExportFormat::Json;
+}
+
+// Поле CSV (RFC 4180): в кавычки берется только значение с запятой, кавычкой или переводом строки
+void writeCsvField(simple_json::writer& out, string_view v) {
+    if (v.find_first_of(",\"\r\n") == string_view::npos) {
+        out.raw(v);
+        return;
+    }
+    out.raw("\"");
+    size_t from = 0, quote;
+    while ((quote = v.find('"', from)) != string_view::npos) {
+        out.raw(v.substr(from, quote + 1 - from));
+        out.raw("\"");
+        from = quote + 1;
+    }
+    out.raw(v.substr(from));
+    out.raw("\"");
+}
+
+// ISO-запись проверенной даты: сама строка, перестановка полей DD.MM.YYYY и
+// MM/DD/YYYY или (для названия месяца) восстановление по номеру дня
+inline const char* normalizedISO(string_view text, int32_t ordinal, char* iso) {
+    if (text.size() != 10) {
+        writeOrdinalISO(ordinal, iso);
+        return iso;
+    }
+    const char* s = text.data();
+    if (s[4] == '-') return s;
+    const char* day = s[2] == '.' ? s : s + 3;
+    const char* month = s[2] == '.' ? s + 3 : s;
+    memcpy(iso, s + 6, 4);
+    iso[4] = '-';
+    iso[5] = month[0]; iso[6] = month[1];
+    iso[7] = '-';
+    iso[8] = day[0]; iso[9] = day[1];
+    return iso;
+}
+
+// Дата записи i в формате меню (2 — DD.MM.YYYY, 3 — MM/DD/YYYY); только для
+// проверенных записей
+inline string_view formatConverted(const DateBatch& batch, size_t i, int mode, char* buf) {
+    char normalized[10];
+    const char* iso = normalizedISO(batch.iso(i), batch.ordinals[i], normalized);
+    if (mode == 2) writeDMY(iso, buf);
+    else writeMDY(iso, buf);
+    return string_view(buf, 10);
+}
+
+inline const char* convertedKey(int mode) {
+    return mode == 2 ? "date_dmy" : "date_mdy";
+}
+
+// Начало выгрузки: строка заголовка CSV или '[' массива JSON
+void beginConverted(simple_json::writer& out, int mode, ExportFormat format) {
+    if (format == ExportFormat::Csv) {
+        out.raw("name,date_iso,");
+        out.raw(convertedKey(mode));
+        out.raw(",error\n");
+    }
+    else if (format == ExportFormat::Json) {
+        out.begin_array();
+    }
+}
+
+void endConverted(simple_json::writer& out, ExportFormat format) {
+    if (format == ExportFormat::Json) out.end_array();
+}
+
+// Записи пакета: исходные name и date_iso, дата в новом формате (строится
+// здесь же из date_iso проверенной записи) и код ошибки (если есть).
+// Пакетов между beginConverted и endConverted может быть несколько
+void writeConverted(simple_json::writer& out, const DateBatch& data, int mode, ExportFormat format) {
+    const char* converted_key = convertedKey(mode);
+    char converted[10];
+    if (format == ExportFormat::Csv) {
+        for (size_t i = 0; i < data.size(); i++) {
+            writeCsvField(out, data.name(i));
+            out.raw(",");
+            writeCsvField(out, data.iso(i));
+            out.raw(",");
+            if (data.converted(i)) out.raw(formatConverted(data, i, mode, converted));
+            out.raw(",");
+            if (data.errors[i] != DateError::None) out.raw(dateErrorCode(data.errors[i]));
+            out.raw("\n");
+        }
+    }
+    else {
+        bool lines = format == ExportFormat::Ndjson;
+        for (size_t i = 0; i < data.size(); i++) {
+            out.begin_object();
+            out.field("name", data.name(i));
+            out.field("date_iso", data.iso(i));
+            if (data.converted(i)) out.field(converted_key, formatConverted(data, i, mode, converted));
+            if (data.errors[i] != DateError::None) out.field("error", dateErrorCode(data.errors[i]));
+            out.end_object();
+            if (lines) out.end_line();
+        }
+    }
+}
+
+// Сохранение результатов конвертации одним файлом. Запись идет через буфер
+// writer'а крупными блоками. bytes — необязательный размер результата
+bool saveConverted(const string& fname, const DateBatch& data, int mode,
+    ExportFormat format = ExportFormat::Json, unsigned long long* bytes = nullptr) {
+    static thread_local simple_json::writer out;
+    if (!out.open(fname)) return false;
+
+    beginConverted(out, mode, format);
+    writeConverted(out, data, mode, format);
+    endConverted(out, format);
+
+    if (bytes) *bytes = out.bytes();
+    return out.close();
+}
+
+// Итог потоковой обработки файла; время этапов в микросекундах
+struct StreamStats {
+    bool opened = false;
+    bool malformed = false;
+    bool saved = true;
+    size_t records = 0;
+    ConvertStats convert;
+    unsigned long long in_bytes = 0;
+    unsigned long long out_bytes = 0;
+    long long load_us = 0;
+    long long convert_us = 0;
+    long long write_us = 0;
+};
+
+// Файл обрабатывается потоково: при --stream или если он не меньше kStreamMinFileSize
+bool useStream(const string& fname, bool force) {
+    if (force) return true;
+    error_code ec;
+    auto size = fs::file_size(fname, ec);
+    return !ec && size >= kStreamMinFileSize;
+}
+
+// Потоковая проверка файла пакетами из окна DateStream и, если out_name не
+// пуст, запись результата по мере обработки. В памяти одновременно только
+// окно, один пакет и буфер записи. progress — раз в секунду печатать в
+// stderr число записей и скорость
+StreamStats streamConvert(const string& fname, const string& out_name, int mode, ExportFormat format, bool progress) {
+    StreamStats st;
+    DateStream in(fname);
+    st.opened = in.ok();
+    if (!st.opened) return st;
+
+    auto us_between = [](chrono::high_resolution_clock::time_point from, chrono::high_resolution_clock::time_point to) {
+        return static_cast<long long>(chrono::duration_cast<chrono::microseconds>(to - from).count());
+    };
+
+    simple_json::writer out;
+    bool writing = false;
+    bool shown = false;
+    DateBatch batch;
+    auto start = chrono::high_resolution_clock::now();
+    auto last_report = start;
+    while (true) {
+        auto t0 = chrono::high_resolution_clock::now();
+        bool more = in.next(batch);
+        auto t1 = chrono::high_resolution_clock::now();
+        st.load_us += us_between(t0, t1);
+        if (!more) break;
+
+        st.convert.merge(convertRecordsParallel(batch));
+        st.records += batch.size();
+        auto t2 = chrono::high_resolution_clock::now();
+        st.convert_us += us_between(t1, t2);
+
+        // Файл результата создается с первым пакетом: пустой вход не оставляет выгрузки
+        if (!out_name.empty() && st.saved) {
+            if (!writing) {
+                writing = out.open(out_name);
+                st.saved = writing;
+                if (writing) beginConverted(out, mode, format);
+            }
+            if (writing) writeConverted(out, batch, mode, format);
+        }
+        auto t3 = chrono::high_resolution_clock::now();
+        st.write_us += us_between(t2, t3);
+
+        if (progress && t3 - last_report >= chrono::seconds(1)) {
+            double sec = chrono::duration<double>(t3 - start).count();
+            cerr << "\r" << fname << ": " << st.records << " записей, "
+                << static_cast<long long>(st.records / sec) << " записей/с, "
+                << (in.bytesParsed() >> 20) << " МБ" << flush;
+            last_report = t3;
+            shown = true;
+        }
+    }
+    if (shown) cerr << "\n";
+
+    if (writing) {
+        auto t0 = chrono::high_resolution_clock::now();
+        endConverted(out, format);
+        st.out_bytes = out.bytes();
+        st.saved = out.close();
+        st.write_us += us_between(t0, chrono::high_resolution_clock::now());
+    }
+    st.malformed = in.malformed();
+    st.in_bytes = in.bytesParsed();
+    return st;
+}
+
+// ===================== КЭШ РАЗБОРА =====================
+// Рядом с <имя>.json пишется <имя>.json.dcache: заголовок и столбцы уже
+// проверенных записей (номер дня, ссылки на name и date_iso в блоке строк,
+// код ошибки). Повторный запуск отображает кэш вместо разбора JSON: analyze
+// считает итог прямо по столбцу ошибок, convert берет записи как есть.
+// Кэш действителен, пока у исходного файла прежние размер и время
+// изменения; если изменилось только время, сравнивается хеш содержимого.
+
+const char kCacheMagic[8] = { 'D', 'C', 'C', 'A', 'C', 'H', 'E', '1' };
+// Менять при любом изменении правил разбора или проверки
+const uint32_t kCacheVersion = 1;
+const uint32_t kCacheMalformed = 1;  // флаг: исходный JSON поврежден
+
+struct DateCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t source_size;
+    int64_t source_mtime;       // как в sourceStamp
+    uint64_t source_hash;
+    int32_t min_year;           // диапазон лет сборки: от него зависят номера дней
+    int32_t max_year;
+    uint64_t records;
+    uint64_t text_size;
+};
+
+// Смещения столбцов: ordinals (int32), names и isos (TextRef), errors (байт), строки
+struct DateCacheLayout {
+    size_t ordinals, names, isos, errors, text, total;
+
+    DateCacheLayout(uint64_t n, uint64_t text_size) {
+        ordinals = sizeof(DateCacheHeader);
+        names = ordinals + n * sizeof(int32_t);
+        isos = names + n * sizeof(TextRef);
+        errors = isos + n * sizeof(TextRef);
+        text = errors + n;
+        total = text + text_size;
+    }
+};
+
+inline string cachePath(const string& source) {
+    return source + ".dcache";
+}
+
+// Хеш содержимого по 8 байт за шаг (умножение и перемешивание)
+uint64_t contentHash(string_view s) {
+    const uint64_t k = 0xff51afd7ed558ccdull;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ s.size();
+    size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8) {
+        uint64_t w;
+        memcpy(&w, s.data() + i, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, s.data() + i, s.size() - i);
+    h = (h ^ tail) * k;
+    return h ^ (h >> 29);
+}
+
+// Размер и время изменения файла; false — файла нет. Время сравнивается
+// только на равенство, его единицы зависят от платформы. На POSIX — один
+// вызов stat: манифест снимает отметки со всех файлов корпуса при каждом запуске
+bool sourceStamp(const string& path, uint64_t& size, int64_t& mtime) {
+#ifdef _WIN32
+    error_code ec;
+    size = fs::file_size(path, ec);
+    if (ec) return false;
+    auto t = fs::last_write_time(path, ec);
+    if (ec) return false;
+    mtime = static_cast<int64_t>(t.time_since_epoch().count());
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+
+// Отметка файла, снятая до его чтения
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+// Кэш проверенных записей файла в отображении
+class DateCache {
+    MappedFile map;
+    const DateCacheHeader* hdr = nullptr;
+
+    // Столбцы поврежденного или чужого кэша не используются: код ошибки —
+    // известная категория, номер дня корректной записи — в диапазоне сборки,
+    // ссылки на строки — внутри блока строк (без признака раскодированной строки)
+    bool validColumns(const DateCacheHeader* h) const {
+        DateCacheLayout layout(h->records, h->text_size);
+        size_t n = static_cast<size_t>(h->records);
+        const char* base = map.data();
+        const int32_t max_ordinal = dayOrdinal(kMaxYear, 12, 31);
+        for (size_t i = 0; i < n; i++) {
+            uint8_t e = static_cast<uint8_t>(base[layout.errors + i]);
+            if (e >= kDateErrorCount) return false;
+            if (e == static_cast<uint8_t>(DateError::None)) {
+                int32_t day;
+                memcpy(&day, base + layout.ordinals + i * sizeof(int32_t), sizeof(day));
+                if (day < 0 || day > max_ordinal) return false;
+            }
+            TextRef refs[2];
+            memcpy(&refs[0], base + layout.names + i * sizeof(TextRef), sizeof(TextRef));
+            memcpy(&refs[1], base + layout.isos + i * sizeof(TextRef), sizeof(TextRef));
+            for (const TextRef& r : refs) {
+                if ((r.length & TextRef::kDecodedBit) ||
+                    static_cast<uint64_t>(r.offset) + r.length > h->text_size) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Новое время изменения пишется в копию кэша, которая заменяет его
+    // переименованием: отображение остается на прежнем файле, а читатель
+    // видит либо старый, либо новый кэш целиком. Неудача не мешает
+    // использовать кэш — хэш будет сверен снова при следующем открытии
+    void refreshStamp(const string& source, int64_t mtime) const {
+        DateCacheHeader h;
+        memcpy(&h, map.data(), sizeof(h));
+        h.source_mtime = mtime;
+        simple_json::writer out;
+        string path = cachePath(source), tmp = path + ".tmp";
+        if (!out.open(tmp)) return;
+        out.raw(string_view(reinterpret_cast<const char*>(&h), sizeof(h)));
+        out.raw(map.view().substr(sizeof(h)));
+        error_code ec;
+        if (!out.close()) {
+            fs::remove(tmp, ec);
+            return;
+        }
+        fs::rename(tmp, path, ec);
+    }
+
+public:
+    // Открытие кэша файла source; false — кэша нет или он устарел
+    bool open(const string& source) {
+        hdr = nullptr;
+        uint64_t size;
+        int64_t mtime;
+        if (!sourceStamp(source, size, mtime)) return false;
+        map = MappedFile(cachePath(source));
+        if (map.size() < sizeof(DateCacheHeader)) return false;
+
+        const auto* h = reinterpret_cast<const DateCacheHeader*>(map.data());
+        if (memcmp(h->magic, kCacheMagic, sizeof(kCacheMagic)) != 0 || h->version != kCacheVersion ||
+            h->min_year != kMinYear || h->max_year != kMaxYear || h->source_size != size ||
+            h->records > map.size() || h->text_size > map.size() ||  // без переполнения в DateCacheLayout
+            DateCacheLayout(h->records, h->text_size).total != map.size()) {
+            return false;
+        }
+        if (!validColumns(h)) return false;
+        if (h->source_mtime != mtime) {
+            // Файл скопирован или тронут: кэш годен, если содержимое то же.
+            // Новое время сохраняется, чтобы не хешировать снова, только если
+            // файл не менялся, пока считался хэш
+            MappedFile src(source);
+            if (contentHash(src.view()) != h->source_hash) return false;
+            uint64_t size_after;
+            int64_t mtime_after;
+            if (sourceStamp(source, size_after, mtime_after) && size_after == size && mtime_after == mtime) {
+                refreshStamp(source, mtime);
+            }
+        }
+        hdr = h;
+        return true;
+    }
+
+    size_t size() const { return hdr ? static_cast<size_t>(hdr->records) : 0; }
+    bool malformed() const { return hdr && (hdr->flags & kCacheMalformed); }
+    uint64_t sourceHash() const { return hdr ? hdr->source_hash : 0; }
+
+    const DateError* errors() const {
+        return reinterpret_cast<const DateError*>(map.data() + DateCacheLayout(hdr->records, hdr->text_size).errors);
+    }
+
+    // Итог проверки по столбцу ошибок: записи кэша уже проверены
+    ConvertStats stats() const {
+        ConvertStats st;
+        const DateError* e = errors();
+        for (size_t i = 0; i < size(); i++) {
+            if (e[i] == DateError::None) {
+                st.converted++;
+            }
+            else {
+                st.errors++;
+                st.error_kinds.add(e[i]);
+            }
+        }
+        return st;
+    }
+
+    // Записи в виде пакета: столбцы копируются, строки остаются в отображении
+    DateFile take() {
+        DateCacheLayout layout(hdr->records, hdr->text_size);
+        size_t n = size();
+        DateFile file;
+        file.malformed = malformed();
+        DateBatch& b = file.records;
+        b.source = string_view(map.data() + layout.text, static_cast<size_t>(hdr->text_size));
+        auto column = [&](auto& v, size_t offset) {
+            using T = typename decay_t<decltype(v)>::value_type;
+            v.resize(n);
+            if (n) memcpy(v.data(), map.data() + offset, n * sizeof(T));
+        };
+        column(b.ordinals, layout.ordinals);
+        column(b.names, layout.names);
+        column(b.isos, layout.isos);
+        column(b.errors, layout.errors);
+        file.map = move(map);
+        hdr = nullptr;
+        return file;
+    }
+};
+
+// Запись кэша для проверенного пакета (после convertRecords); batch.source —
+// полный текст файла source, before — отметка файла, снятая до его чтения.
+// Пишется во временный файл и переименовывается, поэтому параллельный
+// читатель не увидит недописанный кэш. Если файл изменился после снятия
+// отметки, кэш отбрасывается: иначе старые записи получили бы новую отметку
+bool writeDateCache(const string& source, const SourceStamp& before, const DateBatch& batch, bool malformed) {
+    if (before.size != batch.source.size()) return false;
+
+    size_t n = batch.size();
+    static thread_local string text;
+    static thread_local vector<TextRef> names, isos;
+    text.clear();
+    names.resize(n);
+    isos.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        string_view name = batch.name(i), iso = batch.iso(i);
+        names[i] = { static_cast<uint32_t>(text.size()), static_cast<uint32_t>(name.size()) };
+        text.append(name.data(), name.size());
+        isos[i] = { static_cast<uint32_t>(text.size()), static_cast<uint32_t>(iso.size()) };
+        text.append(iso.data(), iso.size());
+    }
+
+    DateCacheHeader hdr{};
+    memcpy(hdr.magic, kCacheMagic, sizeof(kCacheMagic));
+    hdr.version = kCacheVersion;
+    hdr.flags = malformed ? kCacheMalformed : 0;
+    hdr.source_size = before.size;
+    hdr.source_mtime = before.mtime;
+    hdr.source_hash = contentHash(batch.source);
+    hdr.min_year = kMinYear;
+    hdr.max_year = kMaxYear;
+    hdr.records = n;
+    hdr.text_size = text.size();
+
+    auto bytes = [](const auto* p, size_t count) {
+        return string_view(reinterpret_cast<const char*>(p), count * sizeof(*p));
+    };
+    static thread_local simple_json::writer out;
+    string path = cachePath(source), tmp = path + ".tmp";
+    if (!out.open(tmp)) return false;
+    out.raw(bytes(&hdr, 1));
+    out.raw(bytes(batch.ordinals.data(), n));
+    out.raw(bytes(names.data(), n));
+    out.raw(bytes(isos.data(), n));
+    out.raw(bytes(batch.errors.data(), n));
+    out.raw(text);
+    error_code ec;
+    SourceStamp after;
+    if (!out.close() || !sourceStamp(source, after.size, after.mtime) ||
+        after.size != before.size || after.mtime != before.mtime) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    fs::rename(tmp, path, ec);
+    return !ec;
+}
+
+// Конвертация большого файла без загрузки целиком: имя результата
+// спрашивается заранее, записи пишутся по мере обработки
+void convertStreamed(const string& fname, int mode) {
+    cout << "Файл не меньше " << (kStreamMinFileSize >> 20) << " МБ, обработка потоковая.\n";
+    cout << "Сохранить результат (.json, .ndjson, .csv; '-' — не сохранять): ";
+    string out_name;
+    cin >> out_name;
+    if (out_name == "-") out_name.clear();
+
+    auto start = chrono::high_resolution_clock::now();
+    StreamStats st = streamConvert(fname, out_name, mode, exportFormatForPath(out_name), true);
+    auto end = chrono::high_resolution_clock::now();
+    if (st.records == 0) {
+        cout << "Файл пуст или не найден!\n";
+        return;
+    }
+
+    ReportSink& report = menuReport();
+    report.begin("convert", "РЕЗУЛЬТАТЫ КОНВЕРТАЦИИ");
+    auto total_ms = chrono::duration_cast<chrono::milliseconds>(end - start).count();
+    report.section("summary", "СВОДКА");
+    report.count("records", "Всего записей:", static_cast<long long>(st.records));
+    report.count("converted", "Конвертировано:", st.convert.converted);
+    report.count("errors", "Найдено ошибок:", st.convert.errors);
+    report.count("load_ms", "Время загрузки:", st.load_us / 1000, " мс");
+    report.count("convert_ms", "Время конвертации:", st.convert_us / 1000, " мс");
+    report.count("write_ms", "Время записи:", st.write_us / 1000, " мс");
+    report.count("time_ms", "Общее время:", total_ms, " мс");
+    if (total_ms > 0) report.number("records_per_second", "Записей в секунду:", st.records * 1000.0 / total_ms);
+    if (!out_name.empty() && st.saved) {
+        report.text("output", "Результат сохранен в файл:", out_name);
+        report.count("out_bytes", "Записано байт:", static_cast<long long>(st.out_bytes));
+    }
+    report.end_section();
+    if (st.malformed) report.note("Структура JSON нарушена: записи после места ошибки не обработаны");
+    if (st.convert.errors > 0) reportErrorCounts(report, st.convert.error_kinds);
+    if (!out_name.empty() && !st.saved) report.note("Не удалось записать файл " + out_name);
+    report.end();
+}
+
+void convert(int mode) {
+    cout << "Имя файла: ";
+    string fname;
+    cin >> fname;
+
+    if (useStream(fname, false)) {
+        convertStreamed(fname, mode);
+        return;
+    }
+
+    auto start_load = chrono::high_resolution_clock::now();
+    DateFile file = loadDates(fname);
+    auto& data = file.records;
+    auto end_load = chrono::high_resolution_clock::now();
+
+    if (data.empty()) {
+        cout << "Файл пуст или не найден!\n";
+        return;
+    }
+
+    auto start_convert = chrono::high_resolution_clock::now();
+
+    LatencyHistogram latency;
+    ConvertStats st = convertRecordsParallel(data, &latency);
+
+    auto end_convert = chrono::high_resolution_clock::now();
+
+    ReportSink& report = menuReport();
+    report.begin("convert", "РЕЗУЛЬТАТЫ КОНВЕРТАЦИИ");
+    reportLatency(report, "latency", "ВРЕМЯ ОБРАБОТКИ ЗАПИСИ (каждая " + to_string(kLatencySample) + "-я)", latency);
+
+    auto load_time = chrono::duration_cast<chrono::milliseconds>(end_load - start_load);
+    auto convert_time = chrono::duration_cast<chrono::milliseconds>(end_convert - start_convert);
+    auto total_time = load_time + convert_time;
+
+    report.section("summary", "СВОДКА");
+    report.count("records", "Всего записей:", static_cast<long long>(data.size()));
+    report.count("valid", "Корректных дат:", st.converted);
+    report.count("converted", "Конвертировано:", st.converted);
+    report.count("errors", "Найдено ошибок:", st.errors);
+    report.count("load_ms", "Время загрузки:", load_time.count(), " мс");
+    report.count("convert_ms", "Время конвертации:", convert_time.count(), " мс");
+    report.count("time_ms", "Общее время:", total_time.count(), " мс");
+    if (total_time.count() > 0) {
+        report.number("records_per_second", "Записей в секунду:", (data.size() * 1000.0) / total_time.count());
+    }
+    report.end_section();
+
+    if (st.errors > 0) reportErrorCounts(report, st.error_kinds);
+
+    // Пример конвертации (только в таблице)
+    report.note("\n=== ПРИМЕР КОНВЕРТАЦИИ ===");
+    int examples_shown = 0;
+    char converted[10];
+    for (size_t i = 0; i < data.size() && examples_shown < 3; i++) {
+        if (data.converted(i)) {
+            report.note(string(data.iso(i)) + " -> " + string(formatConverted(data, i, mode, converted)));
+            examples_shown++;
+        }
+    }
+    report.end();
+
+    cout << "\nСохранить результат (.json, .ndjson, .csv; '-' — не сохранять): ";
+    string out_name;
+    cin >> out_name;
+    if (out_name.empty() || out_name == "-") return;
+
+    unsigned long long bytes = 0;
+    auto start_save = chrono::high_resolution_clock::now();
+    bool saved = saveConverted(out_name, data, mode, exportFormatForPath(out_name), &bytes);
+    auto end_save = chrono::high_resolution_clock::now();
+    if (!saved) {
+        cout << "Не удалось записать файл " << out_name << "\n";
+        return;
+    }
+
+    auto save_us = chrono::duration_cast<chrono::microseconds>(end_save - start_save).count();
+    report.begin("save", "");
+    report.text("output", "Результат сохранен в файл:", out_name);
+    report.count("out_bytes", "Записано байт:", static_cast<long long>(bytes));
+    report.count("write_ms", "Время записи:", save_us / 1000, " мс");
+    if (save_us > 0) report.number("write_mb_s", "Скорость записи:", static_cast<double>(bytes) / save_us, " МБ/с");
+    report.end();
+}
+
+// Итог анализа набора файлов
+struct AnalyzeStats {
+    int files = 0;
+    int mixed_files = 0, correct_files = 0, error_files = 0;
+    int malformed_files = 0;  // JSON с синтаксической ошибкой (учтены записи до нее)
+    long long total = 0, valid = 0, errors = 0;
+    int unchanged_files = 0;  // итог взят из манифеста без обработки
+    ErrorCounts error_kinds;
+
+    void merge(const AnalyzeStats& o) {
+        files += o.files;
+        unchanged_files += o.unchanged_files;
+        mixed_files += o.mixed_files;
+        correct_files += o.correct_files;
+        error_files += o.error_files;
+        malformed_files += o.malformed_files;
+        total += o.total;
+        valid += o.valid;
+        errors += o.errors;
+        error_kinds.merge(o.error_kinds);
+    }
+};
+
+// Тип файла определяется по префиксу имени, как его создал генератор
+void countFileKind(const string& filename, AnalyzeStats& st) {
+    string base = fs::path(filename).filename().string();
+    if (base.rfind("mixed_data_", 0) == 0) st.mixed_files++;
+    else if (base.rfind("error_data_", 0) == 0) st.error_files++;
+    else st.correct_files++;
+}
+
+// Разбор и проверка одного прочитанного файла с накоплением статистики;
+// cache_stamp — отметка файла до чтения, если записи сохраняются в кэш разбора
+void analyzeFile(const string& filename, const PrefetchedFile& text, AnalyzeStats& st,
+    const SourceStamp* cache_stamp) {
+    st.files++;
+    countFileKind(filename, st);
+
+    DateFile file = parsePrefetched(text);
+    auto& data = file.records;
+    if (file.malformed) st.malformed_files++;
+    ConvertStats cs = convertRecordsParallel(data);
+    if (cache_stamp && !data.empty()) writeDateCache(filename, *cache_stamp, data, file.malformed);
+    st.total += data.size();
+    st.valid += cs.converted;
+    st.errors += cs.errors;
+    st.error_kinds.merge(cs.error_kinds);
+}
+
+// Итог файла прямо по столбцу ошибок кэша, без разбора
+void analyzeCached(const string& filename, const DateCache& cache, AnalyzeStats& st) {
+    st.files++;
+    countFileKind(filename, st);
+    if (cache.malformed()) st.malformed_files++;
+
+    ConvertStats cs = cache.stats();
+    st.total += static_cast<long long>(cache.size());
+    st.valid += cs.converted;
+    st.errors += cs.errors;
+    st.error_kinds.merge(cs.error_kinds);
+}
+
+// ===================== МАНИФЕСТ АНАЛИЗА =====================
+// Итоги анализа по файлам сохраняются между запусками: путь, размер, время
+// изменения, хеш содержимого и счетчики записей. Следующий запуск обрабатывает
+// только новые и измененные файлы, итог остальных берется из манифеста.
+// Формат текстовый, строка на файл:
+//   размер время хеш поврежден записей ошибки_по_видам... путь
+// Путь — до конца строки, как он был передан анализу.
+
+const char kManifestTag[] = "dcmanifest";
+// Менять при любом изменении правил разбора или проверки (как kCacheVersion)
+const int kManifestVersion = 1;
+const char kManifestFile[] = "date_convertor.manifest";
+
+struct ManifestEntry {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;      // 0 — не вычислялся (потоковый файл)
+    AnalyzeStats stats;     // итог одного файла
+    bool seen = false;      // обновлена в этом запуске (см. prune)
+};
+
+class AnalyzeManifest {
+    unordered_map<string, ManifestEntry> entries;
+
+public:
+    size_t size() const { return entries.size(); }
+
+    // Загрузка; false — файла нет или он другой версии (манифест остается пустым)
+    bool load(const string& path) {
+        entries.clear();
+        ifstream in(path, ios::binary);
+        if (!in) return false;
+        string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+        char tag[16] = {};
+        int version = 0, min_year = 0, max_year = 0, kinds = 0, header = 0;
+        if (sscanf(text.c_str(), "%15s %d %d %d %d%n", tag, &version, &min_year, &max_year, &kinds, &header) != 5 ||
+            strcmp(tag, kManifestTag) != 0 || version != kManifestVersion ||
+            min_year != kMinYear || max_year != kMaxYear || kinds != kDateErrorCount) {
+            return false;
+        }
+
+        // Записи собираются отдельно: при ошибке манифест остается пустым
+        const char* p = text.c_str() + header;
+        unordered_map<string, ManifestEntry> loaded;
+        loaded.reserve(count(p, text.c_str() + text.size(), '\n'));
+        while (*p) {
+            const char* eol = strchr(p, '\n');
+            if (!eol) break;
+            if (eol == p) {
+                p++;
+                continue;
+            }
+            ManifestEntry e;
+            char* q;
+            e.size = strtoull(p, &q, 10);
+            e.mtime = strtoll(q, &q, 10);
+            e.hash = strtoull(q, &q, 10);
+            bool malformed = strtol(q, &q, 10) != 0;
+            long long total = static_cast<long long>(strtoull(q, &q, 10));
+            AnalyzeStats& st = e.stats;
+            for (int k = 1; k < kDateErrorCount; k++) {
+                st.error_kinds.by_kind[k] = static_cast<long long>(strtoull(q, &q, 10));
+                st.errors += st.error_kinds.by_kind[k];
+            }
+            if (q >= eol || *q != ' ') return false;  // обрезанная строка
+            string file(q + 1, static_cast<size_t>(eol - q - 1));
+            st.files = 1;
+            countFileKind(file, st);
+            st.malformed_files = malformed ? 1 : 0;
+            st.total = total;
+            st.valid = total - st.errors;
+            loaded[move(file)] = e;
+            p = eol + 1;
+        }
+        entries.swap(loaded);
+        return true;
+    }
+
+    // Запись во временный файл с переименованием
+    bool save(const string& path) const {
+        string text = string(kManifestTag) + " " + to_string(kManifestVersion) + " " + to_string(kMinYear) + " " +
+            to_string(kMaxYear) + " " + to_string(kDateErrorCount) + "\n";
+        for (const auto& [file, e] : entries) {
+            if (file.find('\n') != string::npos) continue;
+            const AnalyzeStats& st = e.stats;
+            text += to_string(e.size) + " " + to_string(e.mtime) + " " + to_string(e.hash) + " " +
+                (st.malformed_files ? "1 " : "0 ") + to_string(st.total);
+            for (int k = 1; k < kDateErrorCount; k++) text += " " + to_string(st.error_kinds.by_kind[k]);
+            text += " " + file + "\n";
+        }
+
+        string tmp = path + ".tmp";
+        simple_json::writer out;
+        if (!out.open(tmp)) return false;
+        out.raw(text);
+        error_code ec;
+        if (!out.close()) {
+            fs::remove(tmp, ec);
+            return false;
+        }
+        fs::rename(tmp, path, ec);
+        return !ec;
+    }
+
+    // Файл не изменился с прошлого анализа: e.size и e.mtime — текущие, в e
+    // дописываются хеш и итог из манифеста. Если совпал только размер,
+    // сравнивается хеш содержимого
+    bool unchanged(const string& file, ManifestEntry& e) const {
+        auto it = entries.find(file);
+        if (it == entries.end() || it->second.size != e.size) return false;
+        const ManifestEntry& old = it->second;
+        if (old.mtime != e.mtime) {
+            if (!old.hash) return false;
+            MappedFile src(file);
+            if (src.size() != e.size || contentHash(src.view()) != old.hash) return false;
+        }
+        e.hash = old.hash;
+        e.stats = old.stats;
+        return true;
+    }
+
+    void update(const string& file, const ManifestEntry& e) {
+        ManifestEntry& dst = entries[file];
+        dst = e;
+        dst.seen = true;
+    }
+
+    // Удаление записей о файлах, которых больше нет; записи, обновленные
+    // в этом запуске, не проверяются
+    void prune() {
+        error_code ec;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!it->second.seen && !fs::exists(it->first, ec)) {
+                it = entries.erase(it);
+                continue;
+            }
+            it->second.seen = false;
+            ++it;
+        }
+    }
+};
+
+// Настройки анализа набора файлов
+struct AnalyzeOptions {
+    LatencyHistogram* file_latency = nullptr;  // время обработки файла (необязательно)
+    bool stream_all = false;                   // все файлы потоково, иначе только крупные
+    bool use_cache = false;                    // кэш разбора <имя>.json.dcache
+    AnalyzeManifest* manifest = nullptr;       // итоги прошлых запусков; обновляется
+};
+
+// Параллельный анализ: счетчики ведутся в каждом потоке и складываются в конце,
+// поэтому итог не зависит от числа потоков. Файлы, не изменившиеся с прошлого
+// запуска по манифесту, не читаются; файлы с действительным кэшем считаются
+// по нему; остальные читает конвейер, задача пула берет очередной готовый
+// файл; крупные файлы (или все при stream_all) обрабатываются потоково после
+// остальных. Гистограмма времени на файл своя у каждого потока
+AnalyzeStats analyzeFiles(const vector<string>& all_files, const AnalyzeOptions& opt = AnalyzeOptions()) {
+    WorkStealingPool& pool = sharedPool();
+    vector<PerThread<AnalyzeStats>> partial(pool.size());
+    vector<PerThread<LatencyHistogram>> latency(opt.file_latency ? pool.size() : 0);
+    LatencyHistogram* file_latency = opt.file_latency;
+    auto recordLatency = [&](unsigned worker, chrono::high_resolution_clock::time_point start) {
+        if (!file_latency) return;
+        auto end = chrono::high_resolution_clock::now();
+        latency[worker].value.record(static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(end - start).count()));
+    };
+
+    // Новые записи манифеста: размер и время снимаются до чтения файла, чтобы
+    // изменение во время анализа было замечено следующим запуском
+    AnalyzeManifest* manifest = opt.manifest;
+    vector<ManifestEntry> fresh(manifest ? all_files.size() : 0);
+    vector<char> stamped(fresh.size(), 0);
+    auto finish = [&](size_t i, const AnalyzeStats& file_st, uint64_t hash, unsigned worker) {
+        partial[worker].value.merge(file_st);
+        if (!manifest) return;
+        fresh[i].stats = file_st;
+        fresh[i].hash = hash;
+    };
+
+    vector<char> done(all_files.size(), 0);
+    if (manifest) {
+        pool.parallelFor(all_files.size(), [&](size_t i, unsigned worker) {
+            auto start = chrono::high_resolution_clock::now();
+            ManifestEntry& e = fresh[i];
+            if (!sourceStamp(all_files[i], e.size, e.mtime)) return;
+            stamped[i] = 1;
+            if (!manifest->unchanged(all_files[i], e)) return;
+            partial[worker].value.merge(e.stats);
+            partial[worker].value.unchanged_files++;
+            done[i] = 1;
+            recordLatency(worker, start);
+        });
+    }
+
+    // Отметки для нового кэша снимаются до чтения, как и для манифеста
+    vector<SourceStamp> stamps(opt.use_cache ? all_files.size() : 0);
+    vector<char> cache_stamped(stamps.size(), 0);
+    if (opt.use_cache) {
+        pool.parallelFor(all_files.size(), [&](size_t i, unsigned worker) {
+            if (done[i]) return;
+            auto start = chrono::high_resolution_clock::now();
+            if (!sourceStamp(all_files[i], stamps[i].size, stamps[i].mtime)) return;
+            cache_stamped[i] = 1;
+            DateCache cache;
+            if (!cache.open(all_files[i])) return;
+            AnalyzeStats file_st;
+            analyzeCached(all_files[i], cache, file_st);
+            finish(i, file_st, cache.sourceHash(), worker);
+            done[i] = 1;
+            recordLatency(worker, start);
+        });
+    }
+
+    vector<size_t> files, streamed;
+    for (size_t i = 0; i < all_files.size(); i++) {
+        if (!done[i]) (useStream(all_files[i], opt.stream_all) ? streamed : files).push_back(i);
+    }
+
+    vector<string> paths(files.size());
+    for (size_t j = 0; j < files.size(); j++) paths[j] = all_files[files[j]];
+    FilePrefetcher prefetch(paths, prefetchDepth(pool.size()));
+    forEachFile(pool, files.size(), [&](size_t, unsigned worker) {
+        auto start = chrono::high_resolution_clock::now();
+        PrefetchedFile f;
+        if (!prefetch.next(f)) return;
+        AnalyzeStats file_st;
+        size_t i = files[f.index];
+        analyzeFile(paths[f.index], f, file_st, opt.use_cache && cache_stamped[i] ? &stamps[i] : nullptr);
+        finish(i, file_st, manifest ? contentHash(f.text) : 0, worker);
+        prefetch.release(f);
+        recordLatency(worker, start);
+    });
+
+    AnalyzeStats st;
+    for (const auto& p : partial) st.merge(p.value);
+    for (const auto& l : latency) file_latency->merge(l.value);
+
+    for (size_t i : streamed) {
+        const string& fname = all_files[i];
+        auto start = chrono::high_resolution_clock::now();
+        StreamStats ss = streamConvert(fname, "", 2, ExportFormat::Json, true);
+        auto end = chrono::high_resolution_clock::now();
+        AnalyzeStats file_st;
+        file_st.files = 1;
+        countFileKind(fname, file_st);
+        if (ss.malformed) file_st.malformed_files = 1;
+        file_st.total = static_cast<long long>(ss.records);
+        file_st.valid = ss.convert.converted;
+        file_st.errors = ss.convert.errors;
+        file_st.error_kinds = ss.convert.error_kinds;
+        st.merge(file_st);
+        if (manifest) fresh[i].stats = file_st;  // хеш не считается: файл не читается целиком
+        if (file_latency) {
+            file_latency->record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(end - start).count()));
+        }
+    }
+
+    if (manifest) {
+        for (size_t i = 0; i < all_files.size(); i++) {
+            if (stamped[i]) manifest->update(all_files[i], fresh[i]);
+        }
+        manifest->prune();
+    }
+    return st;
+}
+
+// Файлы корпуса в текущем каталоге по индексу: один проход по каталогу вместо
+// проверки каждого имени. При нескольких файлах с одним индексом берется
+// первый по порядку префиксов: mixed_data, correct_data, старые data_/error_data_
+unordered_map<int, string> indexedFiles() {
+    static const char* const prefixes[] = { "mixed_data_", "correct_data_", "data_", "error_data_" };
+    unordered_map<int, pair<int, string>> best;
+    error_code ec;
+    for (const auto& entry : fs::directory_iterator(".", ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        string name = entry.path().filename().string();
+        if (name.size() < 6 || name.compare(name.size() - 5, 5, ".json") != 0) continue;
+        for (int p = 0; p < 4; p++) {
+            size_t len = strlen(prefixes[p]);
+            if (name.compare(0, len, prefixes[p]) != 0) continue;
+            const char* digits = name.c_str() + len;
+            char* end;
+            long index = strtol(digits, &end, 10);
+            if (end == digits || !isDigit(*digits) || end != name.c_str() + name.size() - 5 || index > INT32_MAX) break;
+            auto it = best.find(static_cast<int>(index));
+            if (it == best.end() || p < it->second.first) best[static_cast<int>(index)] = { p, name };
+            break;
+        }
+    }
+    unordered_map<int, string> files;
+    for (auto& [index, found] : best) files.emplace(index, move(found.second));
+    return files;
+}
+
+void analyze() {
+    cout << "Сколько файлов проанализировать? ";
+    int n;
+    cin >> n;
+
+    if (n <= 0) return;
+
+    ReportSink& report = menuReport();
+    report.begin("analyze", "РЕЗУЛЬТАТЫ АНАЛИЗА");
+
+    unordered_map<int, string> found = indexedFiles();
+    vector<string> files;
+    int missing = 0;
+    for (int i = 0; i < n; i++) {
+        auto it = found.find(i);
+        if (it == found.end()) {
+            if (report_files) report.note("Файл с индексом " + to_string(i) + " не найден, пропускаем...");
+            missing++;
+            continue;
+        }
+        files.push_back(it->second);
+    }
+
+    // Корпус в текущем каталоге анализируется многократно: итоги неизмененных
+    // файлов берутся из манифеста, остальные — из кэша разбора, если он
+    // включен (menu --cache)
+    AnalyzeManifest manifest;
+    manifest.load(kManifestFile);
+
+    LatencyHistogram file_latency;
+    AnalyzeOptions options;
+    options.file_latency = &file_latency;
+    options.use_cache = menu_cache;
+    options.manifest = &manifest;
+    AnalyzeStats st = analyzeFiles(files, options);
+    if (!manifest.save(kManifestFile)) report.note(string("Не удалось сохранить ") + kManifestFile);
+
+    reportLatency(report, "latency", "ПРОИЗВОДИТЕЛЬНОСТЬ (время на файл)", file_latency);
+
+    report.section("summary", "ДАННЫЕ");
+    report.count("requested", "Проверено файлов:", n);
+    report.count("missing", "Не найдено файлов:", missing);
+    report.count("mixed", "Смешанных файлов:", st.mixed_files);
+    report.count("correct", "Корректных файлов:", st.correct_files);
+    report.count("error_files", "Файлов с ошибками:", st.error_files);
+    report.count("malformed", "Повреждённый JSON:", st.malformed_files);
+    report.count("unchanged", "Без изменений:", st.unchanged_files);
+    report.count("records", "Всего записей:", st.total);
+    report.count("valid", "Корректных дат:", st.valid);
+    report.count("errors", "Ошибок:", st.errors);
+    if (st.total > 0) {
+        report.number("valid_percent", "Процент корректных:", st.valid * 100.0 / st.total, "%", 1);
+        report.number("error_percent", "Процент ошибок:", st.errors * 100.0 / st.total, "%", 1);
+    }
+    report.end_section();
+
+    if (st.errors > 0) reportErrorCounts(report, st.error_kinds);
+    report.end();
+}
+
+// ===================== ДЕМОН КОНВЕРТАЦИИ =====================
+// serve держит процесс запущенным и принимает запросы по Unix-сокету:
+// запуск, setlocale и меню не повторяются ради десятка дат. Запросы,
+// пришедшие в пределах окна (--batch-us), проверяются одним вызовом
+// convertRecords. Кадры в порядке байтов машины (сокет локальный):
+//   запрос: u32 длина остатка кадра, u8 вид (1 — конвертация, 2 — статистика),
+//           u8 формат (2 — DD.MM.YYYY, 3 — MM/DD/YYYY), u32 число дат,
+//           для каждой даты u16 длина и байты строки
+//   ответ:  u32 длина остатка, u8 статус (0 — ок, 1 — неверный запрос);
+//           конвертация — u32 число дат и для каждой u8 код ошибки (DateError),
+//           за нулевым кодом 10 байт даты; статистика — строка key=value
+// Ответы на соединении идут в порядке запросов; после неверного запроса
+// соединение закрывается.
+
+const uint8_t kServeConvert = 1;
+const uint8_t kServeStats = 2;
+const uint8_t kServeOk = 0;
+const uint8_t kServeBadRequest = 1;
+const uint32_t kServeHeader = 6;            // вид, формат, число дат
+const uint32_t kServeMaxFrame = 1u << 20;
+const size_t kServeMaxBatch = 8192;         // дат в пакете: полный пакет не ждет окна
+const unsigned kServeDefaultWindowUs = 50;
+const char kServeDefaultSocket[] = "date_convertor.sock";
+
+inline void putU32(string& out, uint32_t v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+inline uint32_t getU32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint16_t getU16(const char* p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Длина кадра в его начале (frame[0..3]) по фактическому размеру
+inline void finishFrame(string& frame, size_t start) {
+    uint32_t size = static_cast<uint32_t>(frame.size() - start - 4);
+    memcpy(&frame[start], &size, sizeof(size));
+}
+
+// Кадр запроса конвертации; строки длиннее 65535 байт обрезаются
+string convertRequest(int mode, const vector<string>& dates) {
+    string frame;
+    putU32(frame, 0);
+    frame += static_cast<char>(kServeConvert);
+    frame += static_cast<char>(mode);
+    putU32(frame, static_cast<uint32_t>(dates.size()));
+    for (const auto& d : dates) {
+        uint16_t len = static_cast<uint16_t>(min<size_t>(d.size(), UINT16_MAX));
+        frame.append(reinterpret_cast<const char*>(&len), sizeof(len));
+        frame.append(d.data(), len);
+    }
+    finishFrame(frame, 0);
+    return frame;
+}
+
+string statsRequest() {
+    string frame;
+    putU32(frame, kServeHeader);
+    frame += static_cast<char>(kServeStats);
+    frame += '\0';
+    putU32(frame, 0);
+    return frame;
+}
+
+// Счетчики сервера для запроса статистики
+struct ServeStats {
+    chrono::high_resolution_clock::time_point started = chrono::high_resolution_clock::now();
+    uint64_t connections = 0;
+    uint64_t requests = 0;       // запросы конвертации
+    uint64_t dates = 0;
+    uint64_t valid = 0;
+    uint64_t batches = 0;
+    uint64_t bad_requests = 0;
+    LatencyHistogram latency;    // от приема кадра до готового ответа, нс
+
+    string line() const {
+        double uptime = chrono::duration<double>(chrono::high_resolution_clock::now() - started).count();
+        ostringstream out;
+        out << fixed << setprecision(1)
+            << "serve uptime_s=" << uptime
+            << " connections=" << connections
+            << " requests=" << requests
+            << " dates=" << dates
+            << " valid=" << valid
+            << " batches=" << batches
+            << " bad_requests=" << bad_requests
+            << " dates_per_batch=" << (batches ? static_cast<double>(dates) / batches : 0.0)
+            << " req_s=" << (uptime > 0 ? requests / uptime : 0.0)
+            << " dates_s=" << (uptime > 0 ? dates / uptime : 0.0)
+            << " p50_us=" << latency.percentile(0.50) / 1000.0
+            << " p99_us=" << latency.percentile(0.99) / 1000.0
+            << " max_us=" << latency.maximum() / 1000.0;
+        return out.str();
+    }
+};
+
+#ifndef _WIN32
+
+volatile sig_atomic_t serve_stop = 0;
+
+extern "C" void onServeSignal(int) {
+    serve_stop = 1;
+}
+
+// SIGINT/SIGTERM прерывают poll и завершают цикл; запись в закрытый
+// клиентом сокет возвращает ошибку вместо SIGPIPE
+void installServeSignals() {
+    struct sigaction sa {};
+    sa.sa_handler = onServeSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+// Адрес Unix-сокета; false — путь не помещается в sun_path
+bool unixAddress(const string& path, sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Сервер на одном потоке: poll по всем соединениям, пакет запросов
+// собирается в DateBatch и проверяется целиком, когда истекло окно
+// с прихода первого запроса или набралось kServeMaxBatch дат
+class ConvertServer {
+    struct Connection {
+        int fd = -1;
+        string in;              // принятые байты, еще не разобранные в кадры
+        string out;             // ответы, ожидающие отправки
+        size_t sent = 0;
+        size_t pending = 0;     // запросов соединения в текущем пакете
+        bool eof = false;       // клиент закончил запись или прислал неверный кадр
+        bool broken = false;    // ошибка сокета: соединение закрывается сразу
+    };
+
+    // Запрос в текущем пакете: записи [first, first + count) в batch
+    struct Pending {
+        uint64_t conn;
+        uint8_t kind;           // 0 — неверный запрос
+        uint8_t mode;
+        size_t first, count;
+        chrono::high_resolution_clock::time_point arrived;
+    };
+
+    string path;
+    int listen_fd = -1;
+    chrono::nanoseconds window;
+    unordered_map<uint64_t, Connection> conns;
+    uint64_t next_id = 0;
+    vector<Pending> pending;
+    DateBatch batch;
+    ServeStats stats;
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void acceptAll() {
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            setNonBlocking(fd);
+            conns[next_id++].fd = fd;
+            stats.connections++;
+        }
+    }
+
+    // Даты кадра укладываются ровно в его тело
+    static bool validDates(const char* p, size_t size, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (size < 2) return false;
+            size_t len = getU16(p);
+            if (size - 2 < len) return false;
+            p += 2 + len;
+            size -= 2 + len;
+        }
+        return size == 0;
+    }
+
+    // Разбор полных кадров из c.in в пакет
+    void parseFrames(uint64_t id, Connection& c) {
+        auto now = chrono::high_resolution_clock::now();
+        size_t pos = 0;
+        while (!c.eof && c.in.size() - pos >= 4) {
+            uint32_t size = getU32(c.in.data() + pos);
+            bool framed = size >= kServeHeader && size <= kServeMaxFrame;
+            if (framed && c.in.size() - pos - 4 < size) break;
+
+            Pending p{ id, 0, 0, batch.size(), 0, now };
+            if (framed) {
+                const char* body = c.in.data() + pos + 4;
+                uint8_t kind = static_cast<uint8_t>(body[0]);
+                uint8_t mode = static_cast<uint8_t>(body[1]);
+                uint32_t count = getU32(body + 2);
+                if (kind == kServeStats) {
+                    p.kind = kind;
+                }
+                else if (kind == kServeConvert && (mode == 2 || mode == 3) &&
+                    validDates(body + kServeHeader, size - kServeHeader, count)) {
+                    p.kind = kind;
+                    p.mode = mode;
+                    p.count = count;
+                    const char* q = body + kServeHeader;
+                    for (uint32_t i = 0; i < count; i++) {
+                        size_t len = getU16(q);
+                        batch.push(TextRef(), batch.decodedRef(string_view(q + 2, len)), false);
+                        q += 2 + len;
+                    }
+                    stats.requests++;
+                    stats.dates += count;
+                }
+            }
+            pending.push_back(p);
+            c.pending++;
+            if (!p.kind) {
+                c.eof = true;
+                break;
+            }
+            pos += 4 + size;
+        }
+        c.in.erase(0, pos);
+    }
+
+    void readFrom(uint64_t id, Connection& c) {
+        char buf[1 << 16];
+        ssize_t r;
+        do {
+            r = recv(c.fd, buf, sizeof(buf), 0);
+        } while (r < 0 && errno == EINTR);
+        if (r > 0) {
+            c.in.append(buf, static_cast<size_t>(r));
+            parseFrames(id, c);
+        }
+        else if (r == 0) {
+            c.eof = true;
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            c.broken = true;
+        }
+    }
+
+    void processBatch() {
+        ConvertStats cs = convertRecords(batch);
+        stats.valid += cs.converted;
+        stats.batches++;
+        auto done = chrono::high_resolution_clock::now();
+        char buf[10];
+        for (const auto& p : pending) {
+            auto it = conns.find(p.conn);
+            if (it == conns.end()) continue;
+            Connection& c = it->second;
+            c.pending--;
+            size_t start = c.out.size();
+            putU32(c.out, 0);
+            if (p.kind == kServeConvert) {
+                c.out += static_cast<char>(kServeOk);
+                putU32(c.out, static_cast<uint32_t>(p.count));
+                for (size_t i = p.first; i < p.first + p.count; i++) {
+                    c.out += static_cast<char>(batch.errors[i]);
+                    if (batch.errors[i] == DateError::None) c.out.append(formatConverted(batch, i, p.mode, buf).data(), 10);
+                }
+            }
+            else if (p.kind == kServeStats) {
+                c.out += static_cast<char>(kServeOk);
+                c.out += stats.line();
+            }
+            else {
+                c.out += static_cast<char>(kServeBadRequest);
+                stats.bad_requests++;
+            }
+            finishFrame(c.out, start);
+            stats.latency.record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(done - p.arrived).count()));
+        }
+        pending.clear();
+        batch.clear();
+    }
+
+    // Отправка накопленных ответов; закрытие завершенных соединений
+    void flushAll() {
+        for (auto it = conns.begin(); it != conns.end();) {
+            Connection& c = it->second;
+            while (!c.broken && c.sent < c.out.size()) {
+                ssize_t w = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, 0);
+                if (w > 0) {
+                    c.sent += static_cast<size_t>(w);
+                    continue;
+                }
+                if (w < 0 && errno == EINTR) continue;
+                if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK) c.broken = true;
+                break;
+            }
+            if (c.sent == c.out.size()) {
+                c.out.clear();
+                c.sent = 0;
+            }
+            if (c.broken || (c.eof && !c.pending && c.out.empty())) {
+                ::close(c.fd);
+                it = conns.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+public:
+    explicit ConvertServer(unsigned window_us) : window(chrono::microseconds(window_us)) {}
+
+    ConvertServer(const ConvertServer&) = delete;
+    ConvertServer& operator=(const ConvertServer&) = delete;
+
+    ~ConvertServer() {
+        for (auto& [id, c] : conns) ::close(c.fd);
+        if (listen_fd >= 0) {
+            ::close(listen_fd);
+            ::unlink(path.c_str());
+        }
+    }
+
+    // Открытие сокета; оставшийся от прошлого запуска файл сокета удаляется
+    bool listen(const string& socket_path) {
+        sockaddr_un addr;
+        if (!unixAddress(socket_path, addr)) return false;
+        struct stat st;
+        if (::stat(socket_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) ::unlink(socket_path.c_str());
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 128) != 0) {
+            ::close(fd);
+            return false;
+        }
+        setNonBlocking(fd);
+        listen_fd = fd;
+        path = socket_path;
+        return true;
+    }
+
+    // poll с таймаутом: на Linux ppoll ждет с точностью окна в микросекундах,
+    // иначе таймаут округляется вверх до миллисекунды. Округление вниз
+    // превращало бы окно короче миллисекунды в опрос без ожидания
+    static int waitReady(vector<pollfd>& fds, chrono::nanoseconds timeout) {
+#ifdef __linux__
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+        return ppoll(fds.data(), fds.size(), &ts, nullptr);
+#else
+        auto ms = chrono::ceil<chrono::milliseconds>(timeout);
+        return poll(fds.data(), fds.size(), static_cast<int>(ms.count()));
+#endif
+    }
+
+    // Цикл обработки до SIGINT/SIGTERM
+    void run() {
+        vector<pollfd> fds;
+        vector<uint64_t> ids;
+        while (!serve_stop) {
+            // Ожидание до конца окна сбора пакета; при простое — 100 мс,
+            // чтобы проверить флаг остановки
+            chrono::nanoseconds timeout = chrono::milliseconds(100);
+            if (!pending.empty()) {
+                auto left = window - (chrono::high_resolution_clock::now() - pending.front().arrived);
+                timeout = max(chrono::nanoseconds(0), chrono::duration_cast<chrono::nanoseconds>(left));
+            }
+
+            fds.assign(1, pollfd{ listen_fd, POLLIN, 0 });
+            ids.clear();
+            for (const auto& [id, c] : conns) {
+                short events = c.eof ? 0 : POLLIN;
+                if (c.sent < c.out.size()) events |= POLLOUT;
+                fds.push_back(pollfd{ c.fd, events, 0 });
+                ids.push_back(id);
+            }
+            int ready = waitReady(fds, timeout);
+            if (ready < 0 && errno != EINTR) break;
+            if (ready > 0) {
+                if (fds[0].revents & POLLIN) acceptAll();
+                for (size_t k = 1; k < fds.size(); k++) {
+                    Connection& c = conns[ids[k - 1]];
+                    if (fds[k].revents & (POLLERR | POLLNVAL)) c.broken = true;
+                    else if (!c.eof && (fds[k].revents & (POLLIN | POLLHUP))) readFrom(ids[k - 1], c);
+                }
+            }
+
+            if (!pending.empty() && (batch.size() >= kServeMaxBatch ||
+                chrono::high_resolution_clock::now() - pending.front().arrived >= window)) {
+                processBatch();
+            }
+            flushAll();
+        }
+        if (!pending.empty()) processBatch();
+        flushAll();
+    }
+
+    const ServeStats& statistics() const { return stats; }
+};
+
+// Клиент с блокирующим вводом-выводом: запрос и ожидание ответа
+class ConvertClient {
+    int fd = -1;
+
+    bool readAll(char* p, size_t n) {
+        while (n) {
+            ssize_t r = recv(fd, p, n, 0);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) return false;
+            p += r;
+            n -= static_cast<size_t>(r);
+        }
+        return true;
+    }
+
+public:
+    ConvertClient() = default;
+    ConvertClient(const ConvertClient&) = delete;
+    ConvertClient& operator=(const ConvertClient&) = delete;
+
+    ~ConvertClient() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool connect(const string& socket_path) {
+        sockaddr_un addr;
+        if (!unixAddress(socket_path, addr)) return false;
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    // Отправка кадра; body — ответ без поля длины (статус и данные)
+    bool request(const string& frame, string& body) {
+        for (size_t sent = 0; sent < frame.size();) {
+            ssize_t w = send(fd, frame.data() + sent, frame.size() - sent, 0);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            sent += static_cast<size_t>(w);
+        }
+        char len[4];
+        if (!readAll(len, sizeof(len))) return false;
+        body.resize(getU32(len));
+        return !body.empty() && readAll(&body[0], body.size());
+    }
+};
+
+#endif
+
+void runSelfTests() {
+    printHeader("ЗАПУСК САМОТЕСТОВ");
+    total_tests_run = 0;
+    passed_tests = 0;
+
+    printTableHeader();
+
+    // Тест 1: Валидация корректных дат
+    total_tests_run++;
+    auto start = chrono::high_resolution_clock::now();
+    bool test1 = validISO("2024-12-31") && validISO("2000-01-01") && validISO("2024-02-29");
+    auto end = chrono::high_resolution_clock::now();
+    auto time1 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test1) passed_tests++;
+    cout << left << setw(20) << "Валидация корректных"
+        << setw(15) << "3"
+        << setw(15) << time1
+        << setw(15) << (test1 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 2: Валидация некорректных дат
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    bool test2 = !validISO("2024-13-31") && !validISO("2024-12-32") && !validISO("abcd-ef-gh");
+    end = chrono::high_resolution_clock::now();
+    auto time2 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test2) passed_tests++;
+    cout << left << setw(20) << "Валидация ошибок"
+        << setw(15) << "3"
+        << setw(15) << time2
+        << setw(15) << (test2 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 3: Конвертация форматов
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    bool test3 = (iso2dmy("2024-12-31") == "31.12.2024") &&
+        (iso2mdy("2024-12-31") == "12/31/2024");
+    end = chrono::high_resolution_clock::now();
+    auto time3 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test3) passed_tests++;
+    cout << left << setw(20) << "Конвертация"
+        << setw(15) << "2"
+        << setw(15) << time3
+        << setw(15) << (test3 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 4: Генерация смешанных файлов
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    generateMixedFiles(1, 30);  // Создаем 1 файл для теста
+    ifstream test_file1("mixed_data_0.json");
+    ifstream test_file2("correct_data_0.json");
+    bool test4 = test_file1.good() || test_file2.good();
+    end = chrono::high_resolution_clock::now();
+    auto time4 = chrono::duration_cast<chrono::milliseconds>(end - start).count();
+
+    if (test4) passed_tests++;
+    cout << left << setw(20) << "Генерация файлов"
+        << setw(15) << "1"
+        << setw(15) << time4
+        << setw(15) << (test4 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 5: Категории ошибок (все виды ошибок генератора)
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    bool test5 = checkISO("2024/12/31") == DateError::WrongSeparator &&
+        checkISO("31-12-2024") == DateError::WrongOrder &&
+        checkISO("2024-13-45") == DateError::OutOfRange &&
+        checkISO("2023-02-29") == DateError::OutOfRange &&
+        checkISO("abcd-ef-gh") == DateError::NonDigit &&
+        checkISO("2024-12") == DateError::Truncated &&
+        checkISO("") == DateError::Empty &&
+        checkISO("2024-12-31-extra") == DateError::TrailingGarbage;
+    end = chrono::high_resolution_clock::now();
+    auto time5 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test5) passed_tests++;
+    cout << left << setw(20) << "Категории ошибок"
+        << setw(15) << "8"
+        << setw(15) << time5
+        << setw(15) << (test5 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 6: Пакетное ядро совпадает со скалярной проверкой
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    const char* samples[] = { "2024-12-31", "2024-02-29", "2023-02-29", "1900-02-29", "2000-02-29",
+        "2101-01-01", "2024/12/31", "31-12-2024", "abcd-ef-gh", "2024-00-10", "2024-04-31" };
+    const size_t sample_count = sizeof(samples) / sizeof(samples[0]);
+    string packed;
+    for (auto sample : samples) packed += sample;
+    string dmy_simd(sample_count * 10, ' '), mdy_simd(dmy_simd), dmy_scalar(dmy_simd), mdy_scalar(dmy_simd);
+    vector<DateError> err_simd(sample_count), err_scalar(sample_count);
+    convertPackedISO(packed.data(), sample_count, &dmy_simd[0], &mdy_simd[0], err_simd.data());
+    convertPackedScalar(packed.data(), sample_count, &dmy_scalar[0], &mdy_scalar[0], err_scalar.data());
+    bool test6 = err_simd == err_scalar;
+    for (size_t i = 0; test6 && i < sample_count; i++) {
+        if (err_simd[i] != DateError::None) continue;
+        test6 = dmy_simd.compare(i * 10, 10, dmy_scalar, i * 10, 10) == 0 &&
+            mdy_simd.compare(i * 10, 10, mdy_scalar, i * 10, 10) == 0;
+    }
+    end = chrono::high_resolution_clock::now();
+    auto time6 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test6) passed_tests++;
+    cout << left << setw(20) << "Пакетное ядро"
+        << setw(15) << sample_count
+        << setw(15) << time6
+        << setw(15) << (test6 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 7: Выгрузка в CSV с экранированием и кодом ошибки
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    DateBatch export_data;
+    export_data.source = "c2024-12-312024/12/31";
+    export_data.push(export_data.decodedRef("a,\"b\""), export_data.sourceRef(export_data.source.substr(1, 10)), false);
+    export_data.push(export_data.sourceRef(export_data.source.substr(0, 1)),
+        export_data.sourceRef(export_data.source.substr(11, 10)), false);
+    convertRecords(export_data);
+    string export_path = (fs::temp_directory_path() / "date_convertor_selftest.csv").string();
+    bool test7 = saveConverted(export_path, export_data, 2, ExportFormat::Csv);
+    if (test7) {
+        ifstream in(export_path, ios::binary);
+        string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        test7 = content == "name,date_iso,date_dmy,error\n"
+            "\"a,\"\"b\"\"\",2024-12-31,31.12.2024,\n"
+            "c,2024/12/31,,wrong_separator\n";
+    }
+    error_code remove_ec;
+    fs::remove(export_path, remove_ec);
+    end = chrono::high_resolution_clock::now();
+    auto time7 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test7) passed_tests++;
+    cout << left << setw(20) << "Выгрузка CSV"
+        << setw(15) << export_data.size()
+        << setw(15) << time7
+        << setw(15) << (test7 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 8: Таблица дней совпадает с правилами календаря на всем диапазоне
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    const int month_days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int32_t expected_ordinal = 0;
+    bool test8 = true;
+    for (int year = kMinYear; test8 && year <= kMaxYear; year++) {
+        bool leap = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+        for (int month = 1; month <= 12; month++) {
+            int last = month_days[month - 1] + (month == 2 && leap);
+            for (int day = 0; day <= 32; day++) {
+                int32_t ordinal = dayOrdinal(year, month, day);
+                if (day >= 1 && day <= last) test8 &= ordinal == expected_ordinal++;
+                else test8 &= ordinal == -1;
+            }
+        }
+        test8 &= dayOrdinal(year, 0, 1) == -1 && dayOrdinal(year, 13, 1) == -1;
+    }
+    test8 &= dayOrdinal(kMinYear - 1, 12, 31) == -1 && dayOrdinal(kMaxYear + 1, 1, 1) == -1;
+    end = chrono::high_resolution_clock::now();
+    auto time8 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test8) passed_tests++;
+    cout << left << setw(20) << "Таблица дней"
+        << setw(15) << expected_ordinal
+        << setw(15) << time8
+        << setw(15) << (test8 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 9: Повторяющиеся строки с escape-последовательностями хранятся один раз
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    string intern_path = (fs::temp_directory_path() / "date_convertor_selftest.json").string();
+    {
+        ofstream json(intern_path, ios::binary);
+        json << "[";
+        for (int i = 0; i < 100; i++) {
+            json << (i ? "," : "") << "{\"name\":\"\\u0418\\u0432\\u0430\\u043d " << i % 2
+                << "\",\"extra\":\"\\n\",\"date_iso\":\"2024-01-01\"}";
+        }
+        json << "]";
+    }
+    DateFile interned = loadDates(intern_path);
+    bool test9 = interned.records.size() == 100 && !interned.malformed &&
+        interned.records.name(0) == "Иван 0" && interned.records.name(99) == "Иван 1" &&
+        interned.records.decoded.size() == 2 * string("Иван 0").size();
+    // Суррогаты: пара дает один символ, одиночный или без младшей половины —
+    // U+FFFD, а следующая за ним последовательность не теряется
+    {
+        ofstream json(intern_path, ios::binary | ios::trunc);
+        json << "[{\"name\":\"\\ud83d\\ude00\"},{\"name\":\"\\ud83d\\u0041\"},"
+            "{\"name\":\"\\ude00x\"},{\"name\":\"\\uD83D\"}]";
+    }
+    interned = loadDates(intern_path);
+    test9 = test9 && interned.records.size() == 4 && !interned.malformed &&
+        interned.records.name(0) == "\xF0\x9F\x98\x80" && interned.records.name(1) == "\xEF\xBF\xBD" "A" &&
+        interned.records.name(2) == "\xEF\xBF\xBD" "x" && interned.records.name(3) == "\xEF\xBF\xBD";
+    interned = DateFile();
+    fs::remove(intern_path, remove_ec);
+    end = chrono::high_resolution_clock::now();
+    auto time9 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test9) passed_tests++;
+    cout << left << setw(20) << "Интернирование"
+        << setw(15) << 100
+        << setw(15) << time9
+        << setw(15) << (test9 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 10: Потоковое чтение маленьким окном дает те же записи, что и целый файл
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    string stream_path = (fs::temp_directory_path() / "date_convertor_selftest_stream.json").string();
+    {
+        ofstream json(stream_path, ios::binary);
+        json << "\xEF\xBB\xBF [\n";
+        for (int i = 0; i < 50; i++) {
+            json << (i ? ",\n" : "") << "{\"name\":\"\\\"" << string(i * 3, 'x') << "}\\\\\", \"tags\":[{\"a\":\"]\"}],"
+                << "\"date_iso\":\"" << (i % 7 ? "2024-02-29" : "2023-02-29") << "\"}";
+        }
+        json << "\n]\n";
+    }
+    DateFile whole = loadDates(stream_path);
+    convertRecords(whole.records);
+    size_t streamed = 0;
+    bool test10 = !whole.malformed && whole.records.size() == 50;
+    {
+        DateStream in(stream_path, 64);
+        DateBatch batch;
+        while (test10 && in.next(batch)) {
+            convertRecords(batch);
+            for (size_t i = 0; test10 && i < batch.size(); i++, streamed++) {
+                test10 = streamed < whole.records.size() &&
+                    batch.name(i) == whole.records.name(streamed) &&
+                    batch.iso(i) == whole.records.iso(streamed) &&
+                    batch.errors[i] == whole.records.errors[streamed];
+            }
+        }
+        test10 &= streamed == whole.records.size() && !in.malformed();
+    }
+    whole = DateFile();
+    fs::remove(stream_path, remove_ec);
+    end = chrono::high_resolution_clock::now();
+    auto time10 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test10) passed_tests++;
+    cout << left << setw(20) << "Потоковое чтение"
+        << setw(15) << streamed
+        << setw(15) << time10
+        << setw(15) << (test10 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 11: Другие входные форматы приводятся к тому же номеру дня, что и ISO
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    struct FormatCase {
+        const char* text;
+        DateError error;
+    };
+    const FormatCase format_cases[] = {
+        { "31.12.2024", DateError::None }, { "12/31/2024", DateError::None },
+        { "31 декабря 2024", DateError::None }, { "31 декабря 2024 г.", DateError::None },
+        { "29.02.2023", DateError::OutOfRange }, { "31/12/2024", DateError::OutOfRange },
+        { "32 декабря 2024", DateError::OutOfRange }, { "31 декабрь 2024", DateError::NonDigit },
+        { "31-12-2024", DateError::WrongOrder }, { "2024/12/31", DateError::WrongSeparator },
+    };
+    int32_t expected_day = isoOrdinal("2024-12-31");
+    bool test11 = true;
+    for (const auto& c : format_cases) {
+        int32_t day;
+        DateError e = parseDate(c.text, strlen(c.text), day);
+        test11 &= e == c.error && (e != DateError::None || day == expected_day);
+    }
+    for (int m = 1; m <= 12; m++) test11 &= monthByName(kMonthNames[m - 1], strlen(kMonthNames[m - 1])) == static_cast<unsigned>(m);
+    char round_trip[10];
+    for (int32_t day : { 0, 59, 60, expected_day, dayOrdinal(kMaxYear, 12, 31) }) {
+        writeOrdinalISO(day, round_trip);
+        test11 &= checkISO(round_trip, 10) == DateError::None && isoOrdinal(round_trip) == day;
+    }
+    end = chrono::high_resolution_clock::now();
+    auto time11 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test11) passed_tests++;
+    cout << left << setw(20) << "Форматы входа"
+        << setw(15) << sizeof(format_cases) / sizeof(format_cases[0])
+        << setw(15) << time11
+        << setw(15) << (test11 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 12: Кэш разбора возвращает те же записи и устаревает вместе с файлом
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    string cache_source = (fs::temp_directory_path() / "date_convertor_selftest_cache.json").string();
+    {
+        ofstream json(cache_source, ios::binary);
+        json << "[{\"name\":\"a\\u0410\",\"date_iso\":\"2024-12-31\"},{\"name\":\"b\",\"date_iso\":\"31 декабря 2024\"},"
+            "{\"name\":\"c\",\"date_iso\":\"2024/12/31\"},{\"name\":\"d\"}]";
+    }
+    SourceStamp cache_stamp;
+    bool test12 = sourceStamp(cache_source, cache_stamp.size, cache_stamp.mtime);
+    DateFile parsed = loadDates(cache_source);
+    convertRecords(parsed.records);
+    test12 = test12 && writeDateCache(cache_source, cache_stamp, parsed.records, parsed.malformed);
+    DateCache cache;
+    if (test12 && cache.open(cache_source)) {
+        DateFile cached = cache.take();
+        test12 = cached.records.size() == parsed.records.size() && !cached.malformed;
+        for (size_t i = 0; test12 && i < cached.records.size(); i++) {
+            test12 = cached.records.name(i) == parsed.records.name(i) &&
+                cached.records.iso(i) == parsed.records.iso(i) &&
+                cached.records.errors[i] == parsed.records.errors[i] &&
+                cached.records.ordinals[i] == parsed.records.ordinals[i];
+        }
+    }
+    else {
+        test12 = false;
+    }
+    parsed = DateFile();
+    // Тронутый файл с тем же содержимым: кэш годен по хэшу, новое время
+    // сохраняется в кэше
+    {
+        error_code touch_ec;
+        fs::last_write_time(cache_source, fs::last_write_time(cache_source) - chrono::hours(1), touch_ec);
+        SourceStamp touched;
+        test12 &= !touch_ec && sourceStamp(cache_source, touched.size, touched.mtime) && cache.open(cache_source);
+        ifstream raw(cachePath(cache_source), ios::binary);
+        DateCacheHeader hdr{};
+        raw.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+        test12 &= hdr.source_mtime == touched.mtime;
+    }
+    // Поврежденный столбец ошибок: кэш отвергается, а не читается как есть
+    {
+        fstream raw(cachePath(cache_source), ios::in | ios::out | ios::binary);
+        DateCacheHeader hdr;
+        raw.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+        raw.seekp(static_cast<streamoff>(DateCacheLayout(hdr.records, hdr.text_size).errors));
+        raw.put(static_cast<char>(0xFF));
+    }
+    test12 &= !cache.open(cache_source);
+    {
+        ofstream json(cache_source, ios::binary | ios::app);
+        json << " ";
+    }
+    test12 &= !cache.open(cache_source);
+    fs::remove(cache_source, remove_ec);
+    fs::remove(cachePath(cache_source), remove_ec);
+    end = chrono::high_resolution_clock::now();
+    auto time12 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test12) passed_tests++;
+    cout << left << setw(20) << "Кэш разбора"
+        << setw(15) << 4
+        << setw(15) << time12
+        << setw(15) << (test12 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 13: Манифест пропускает неизмененные файлы и пересчитывает измененные
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    fs::path manifest_dir = fs::temp_directory_path() / "date_convertor_selftest_manifest";
+    fs::create_directories(manifest_dir, remove_ec);
+    vector<string> manifest_files = { (manifest_dir / "mixed_data_0.json").string(),
+        (manifest_dir / "correct_data_1.json").string() };
+    auto writeManifestFile = [](const string& path, string_view json) {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << json;
+    };
+    writeManifestFile(manifest_files[0], "[{\"name\":\"a\",\"date_iso\":\"2024-13-01\"},{\"name\":\"b\",\"date_iso\":\"2024-01-01\"}]");
+    writeManifestFile(manifest_files[1], "[{\"name\":\"c\",\"date_iso\":\"2024-02-29\"}]");
+    string manifest_path = (manifest_dir / kManifestFile).string();
+    auto analyzeWithManifest = [&]() {
+        AnalyzeManifest m;
+        m.load(manifest_path);
+        AnalyzeOptions options;
+        options.manifest = &m;
+        AnalyzeStats result = analyzeFiles(manifest_files, options);
+        m.save(manifest_path);
+        return result;
+    };
+    AnalyzeStats first = analyzeWithManifest();
+    AnalyzeStats second = analyzeWithManifest();
+    writeManifestFile(manifest_files[1], "[{\"name\":\"c\",\"date_iso\":\"2023-02-29\"},{\"name\":\"d\"}]");
+    AnalyzeStats third = analyzeWithManifest();
+    // Обрезанная строка после целых: загрузка не удается, записей не остается
+    {
+        ifstream in(manifest_path, ios::binary);
+        string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        in.close();
+        writeManifestFile(manifest_path, text + "12 34\n");
+    }
+    AnalyzeManifest truncated;
+    bool truncated_rejected = !truncated.load(manifest_path) && truncated.size() == 0;
+    bool test13 = truncated_rejected && first.unchanged_files == 0 && first.total == 3 && first.valid == 2 &&
+        second.unchanged_files == 2 && second.total == 3 && second.valid == 2 &&
+        second.error_kinds[DateError::OutOfRange] == 1 && second.mixed_files == 1 &&
+        third.unchanged_files == 1 && third.total == 4 && third.valid == 1 &&
+        third.error_kinds[DateError::OutOfRange] == 2 && third.error_kinds[DateError::MissingField] == 1;
+    fs::remove_all(manifest_dir, remove_ec);
+    end = chrono::high_resolution_clock::now();
+    auto time13 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test13) passed_tests++;
+    cout << left << setw(20) << "Манифест анализа"
+        << setw(15) << 3
+        << setw(15) << time13
+        << setw(15) << (test13 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+#ifndef _WIN32
+    // Тест 14: Демон отвечает на пакет дат, статистику и неверный кадр
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    string serve_path = (fs::temp_directory_path() / ("date_convertor_selftest_" + to_string(getpid()) + ".sock")).string();
+    bool test14 = false;
+    {
+        ConvertServer server(kServeDefaultWindowUs);
+        if (server.listen(serve_path)) {
+            serve_stop = 0;
+            thread serve_thread([&server]() { server.run(); });
+            ConvertClient client, bad_client;
+            string body, stats_body, bad_body;
+            bool answered = client.connect(serve_path) &&
+                client.request(convertRequest(3, { "2024-12-31", "31.12.2024", "2024-13-01" }), body) &&
+                client.request(statsRequest(), stats_body);
+            bool rejected = bad_client.connect(serve_path) &&
+                bad_client.request(string("\x02\0\0\0\x01\x02", 6), bad_body);
+            test14 = answered && rejected &&
+                body == string("\0\x03\0\0\0\0" "12/31/2024" "\0" "12/31/2024" "\x03", 28) &&
+                stats_body.find(" requests=1 dates=3 valid=2 ") != string::npos &&
+                bad_body == string(1, static_cast<char>(kServeBadRequest));
+            serve_stop = 1;
+            serve_thread.join();
+            serve_stop = 0;
+            test14 &= server.statistics().bad_requests == 1;
+        }
+    }
+    end = chrono::high_resolution_clock::now();
+    auto time14 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test14) passed_tests++;
+    cout << left << setw(20) << "Демон конвертации"
+        << setw(15) << 3
+        << setw(15) << time14
+        << setw(15) << (test14 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+#endif
+
+    // Тест 15: Проверка файла частями во всех потоках совпадает с последовательной
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    const char* const chunk_dates[] = { "2024-02-29", "2023-02-29", "31.12.2024", "2024/12/31", "12/31/2024", "" };
+    string chunk_json = "[";
+    size_t chunk_records = kConvertChunk * 3 + 123;
+    for (size_t i = 0; i < chunk_records; i++) {
+        chunk_json += i ? "," : "";
+        chunk_json += "{\"name\":\"n\",\"date_iso\":\"";
+        chunk_json += chunk_dates[(i * 7 + i / 5) % size(chunk_dates)];
+        chunk_json += "\"}";
+    }
+    chunk_json += "]";
+    DateFile serial_file, chunked_file;
+    parseDates(serial_file, chunk_json);
+    parseDates(chunked_file, chunk_json);
+    ConvertStats serial_st = convertRecords(serial_file.records);
+    LatencyHistogram chunk_latency;
+    ConvertStats chunked_st = convertRecordsParallel(chunked_file.records, &chunk_latency);
+    bool test15 = chunked_file.records.size() == chunk_records &&
+        chunked_st.converted == serial_st.converted && chunked_st.errors == serial_st.errors &&
+        chunked_st.error_kinds.by_kind == serial_st.error_kinds.by_kind &&
+        chunked_file.records.errors == serial_file.records.errors &&
+        chunked_file.records.ordinals == serial_file.records.ordinals &&
+        chunk_latency.count() == (chunk_records + kLatencySample - 1) / kLatencySample;
+    // Два потока одновременно запускают задания пула: каждое выполняется целиком
+    {
+        const size_t pool_tasks = 4096;
+        vector<atomic<int>> hits_a(pool_tasks), hits_b(pool_tasks);
+        auto runJob = [&](vector<atomic<int>>& hits) {
+            for (int round = 0; round < 8; round++) {
+                sharedPool().parallelFor(pool_tasks, [&](size_t i, unsigned) { hits[i]++; });
+            }
+        };
+        thread other([&] { runJob(hits_b); });
+        runJob(hits_a);
+        other.join();
+        for (size_t i = 0; i < pool_tasks; i++) test15 = test15 && hits_a[i] == 8 && hits_b[i] == 8;
+    }
+    end = chrono::high_resolution_clock::now();
+    auto time15 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test15) passed_tests++;
+    cout << left << setw(20) << "Проверка частями"
+        << setw(15) << chunk_records
+        << setw(15) << time15
+        << setw(15) << (test15 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    // Тест 16: Тихий отчет только собирает значения, группы — с префиксом
+    total_tests_run++;
+    start = chrono::high_resolution_clock::now();
+    QuietReport quiet;
+    ErrorCounts report_errors;
+    report_errors.add(DateError::WrongOrder);
+    report_errors.add(DateError::WrongOrder);
+    report_errors.add(DateError::Empty);
+    ReportSink& sink = quiet;
+    sink.begin("analyze", "РЕЗУЛЬТАТЫ АНАЛИЗА");
+    sink.count("records", "Всего записей:", 10);
+    reportErrorCounts(sink, report_errors);
+    sink.number("time_ms", "Общее время:", 1.5, " мс");
+    sink.note("только для человека");
+    sink.end();
+    bool test16 = quiet.value("records") == 10 && quiet.value("error_kinds.wrong_order") == 2 &&
+        quiet.value("error_kinds.empty") == 1 && quiet.value("error_kinds.truncated") == -1 &&
+        quiet.value("time_ms") == 1.5;
+    // Итоги больше INT_MAX (потоковый файл или корпус за много дней)
+    // складываются и выводятся без усечения
+    const long long big = 2000000000;
+    ConvertStats big_convert;
+    big_convert.converted = big;
+    big_convert.errors = big / 2;
+    big_convert.error_kinds.by_kind[static_cast<int>(DateError::WrongOrder)] = big / 2;
+    big_convert.merge(big_convert);
+    AnalyzeStats big_part;
+    big_part.total = big_convert.converted + big_convert.errors;
+    big_part.valid = big_convert.converted;
+    big_part.errors = big_convert.errors;
+    big_part.error_kinds = big_convert.error_kinds;
+    AnalyzeStats big_total;
+    big_total.merge(big_part);
+    big_total.merge(big_part);
+    sink.begin("analyze", "РЕЗУЛЬТАТЫ АНАЛИЗА");
+    sink.count("records", "Всего записей:", big_total.total);
+    sink.count("valid", "Корректных дат:", big_total.valid);
+    reportErrorCounts(sink, big_total.error_kinds);
+    sink.end();
+    test16 = test16 && big_total.total > INT_MAX && quiet.value("records") == 6.0 * big &&
+        quiet.value("valid") == 4.0 * big && quiet.value("error_kinds.wrong_order") == 2.0 * big;
+    end = chrono::high_resolution_clock::now();
+    auto time16 = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+    if (test16) passed_tests++;
+    cout << left << setw(20) << "Отчеты"
+        << setw(15) << 3
+        << setw(15) << time16
+        << setw(15) << (test16 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << "\n";
+
+    cout << string(65, '-') << "\n";
+    cout << "\nИТОГО: " << passed_tests << "/" << total_tests_run << " тестов пройдено\n";
+    cout << "УСПЕШНОСТЬ: " << fixed << setprecision(1)
+        << (passed_tests * 100.0 / total_tests_run) << "%\n";
+}
+
+// Значение события на единицу (запись или байт); "н/д", если события нет
+string perUnit(const PerfSample& s, PerfEvent e, double units) {
+    if (!s.has(e) || units <= 0) return "н/д";
+    ostringstream out;
+    out << fixed << setprecision(2) << s[e] / units;
+    return out.str();
+}
+
+void printStageCounters(ostream& out, const BenchmarkResult& result) {
+    out << "\n=== АППАРАТНЫЕ СЧЕТЧИКИ ПО ЭТАПАМ ===\n";
+    if (!result.counters) {
+        out << "Счетчики не собирались\n";
+        return;
+    }
+    bool any = false;
+    for (const auto& s : result.stage_counters) any |= s.any();
+    if (!any) {
+        out << "Счетчики недоступны: " << result.counters_error << "\n";
+#ifdef DC_PERF_EVENTS
+        ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        int level;
+        if (paranoid >> level) {
+            out << "perf_event_paranoid = " << level
+                << " (для счетчиков своего процесса нужно не больше 2 или CAP_PERFMON)\n";
+        }
+#endif
+        return;
+    }
+    double records = result.records_processed;
+    out << "На запись:\n";
+    const char* const head[] = { "Этап", "такты", "инстр.", "IPC", "ветвл.пр.", "L1d пр.", "LLC пр.", "стр.ошибки", "такт/байт" };
+    const size_t width[] = { 13, 10, 10, 7, 11, 10, 10, 12, 10 };
+    for (size_t c = 0; c < size(head); c++) out << padded(head[c], width[c]);
+    out << "\n";
+    for (int k = 0; k < kBenchmarkStages; k++) {
+        const PerfSample& s = result.stage_counters[k];
+        string ipc = "н/д";
+        if (s.has(PerfEvent::Cycles) && s.has(PerfEvent::Instructions) && s[PerfEvent::Cycles] > 0) {
+            ipc = perUnit(s, PerfEvent::Instructions, s[PerfEvent::Cycles]);
+        }
+        // Байты этапа: входной текст до проверки, результат — после
+        double bytes = k <= StageParse ? static_cast<double>(result.input_bytes) : static_cast<double>(result.export_bytes);
+        const string cells[] = {
+            kBenchmarkStageNames[k],
+            perUnit(s, PerfEvent::Cycles, records),
+            perUnit(s, PerfEvent::Instructions, records),
+            ipc,
+            perUnit(s, PerfEvent::BranchMisses, records),
+            perUnit(s, PerfEvent::L1Misses, records),
+            perUnit(s, PerfEvent::LlcMisses, records),
+            s.has(PerfEvent::PageFaults) ? to_string(static_cast<long long>(s[PerfEvent::PageFaults])) : "н/д",
+            perUnit(s, PerfEvent::Cycles, bytes)
+        };
+        for (size_t c = 0; c < size(cells); c++) out << padded(cells[c], width[c]);
+        out << "\n";
+    }
+    out << "(стр.ошибки — всего за этап; такт/байт: загрузка и разбор — на байт входа, остальные — на байт результата)\n";
+    if (!result.counters_error.empty()) out << "Часть событий недоступна: " << result.counters_error << "\n";
+}
+
+void runBenchmark() {
+    printHeader("БЕНЧМАРК ПРОИЗВОДИТЕЛЬНОСТИ");
+
+    cout << "Сколько файлов для теста? ";
+    int n;
+    cin >> n;
+
+    if (n <= 0) return;
+
+    cout << "Собирать аппаратные счетчики (perf_event_open)? 1 — да, 0 — нет: ";
+    int with_counters = 0;
+    cin >> with_counters;
+
+    // Создаем тестовые файлы (смешанные)
+    generateMixedFiles(n, 30);  // 30% ошибок
+
+    BenchmarkResult result;
+    result.counters = with_counters == 1;
+
+    // Пул создается до счетчиков, чтобы они открылись и на его потоках
+    WorkStealingPool& pool = sharedPool();
+    PerfCounters counters;
+
+    // Этапы идут строго друг за другом: время и счетчики каждого не
+    // смешиваются с соседними
+    int stage = 0;
+    chrono::high_resolution_clock::time_point stage_start;
+    auto beginStage = [&](int k) {
+        stage = k;
+        if (result.counters && !counters.start() && result.counters_error.empty()) {
+            result.counters_error = counters.unavailable();
+        }
+        stage_start = chrono::high_resolution_clock::now();
+    };
+    auto endStage = [&]() {
+        auto stage_end = chrono::high_resolution_clock::now();
+        if (result.counters) {
+            result.stage_counters[stage] = counters.stop();
+            if (result.counters_error.empty()) result.counters_error = counters.unavailable();
+        }
+        result.stage_ms[stage] = chrono::duration<double, milli>(stage_end - stage_start).count();
+    };
+
+    vector<string> names(n);
+    for (int i = 0; i < n; i++) {
+        names[i] = "mixed_data_" + to_string(i) + ".json";
+        if (!fs::exists(names[i])) names[i] = "correct_data_" + to_string(i) + ".json";
+    }
+
+    // Загрузка: чтение файлов конвейером, буферы забирают рабочие потоки
+    beginStage(StageLoad);
+    vector<DateFile> all_data(n);
+    vector<string_view> texts(n);
+    {
+        FilePrefetcher prefetch(names, prefetchDepth(pool.size()));
+        pool.parallelFor(n, [&](size_t, unsigned) {
+            PrefetchedFile f;
+            if (!prefetch.next(f)) return;
+            texts[f.index] = f.text;
+            all_data[f.index].owned = prefetch.take(f);
+        });
+    }
+    endStage();
+    for (auto t : texts) result.input_bytes += t.size();
+
+    // Разбор JSON в пакеты
+    beginStage(StageParse);
+    pool.parallelFor(n, [&](size_t i, unsigned) {
+        if (!texts[i].empty()) parseDates(all_data[i], texts[i]);
+    });
+    endStage();
+    all_data.erase(remove_if(all_data.begin(), all_data.end(),
+        [](const DateFile& f) { return f.records.empty(); }), all_data.end());
+    for (const auto& file : all_data) result.records_processed += file.records.size();
+
+    // Проверка (convertRecords: номер дня и код ошибки каждой записи)
+    beginStage(StageValidate);
+    vector<PerThread<ConvertStats>> partial(pool.size());
+    vector<PerThread<LatencyHistogram>> latency(pool.size());
+    pool.parallelFor(all_data.size(), [&](size_t i, unsigned worker) {
+        partial[worker].value.merge(convertRecords(all_data[i].records, &latency[worker].value));
+    });
+    endStage();
+    long long valid_count = 0;
+    long long error_count = 0;
+    LatencyHistogram record_latency;
+    for (size_t w = 0; w < partial.size(); w++) {
+        valid_count += partial[w].value.converted;
+        error_count += partial[w].value.errors;
+        record_latency.merge(latency[w].value);
+    }
+
+    // Конвертация проверенных дат в DD.MM.YYYY в памяти (без сериализации)
+    beginStage(StageConvert);
+    vector<PerThread<string>> converted(pool.size());
+    vector<PerThread<unsigned long long>> converted_bytes(pool.size());
+    pool.parallelFor(all_data.size(), [&](size_t i, unsigned worker) {
+        const DateBatch& batch = all_data[i].records;
+        string& out = converted[worker].value;
+        out.resize(batch.size() * 10);
+        char* p = &out[0];
+        for (size_t r = 0; r < batch.size(); r++) {
+            if (!batch.converted(r)) continue;
+            formatConverted(batch, r, 2, p);
+            p += 10;
+        }
+        converted_bytes[worker].value += p - out.data();
+    });
+    endStage();
+    unsigned long long converted_total = 0;
+    for (const auto& c : converted_bytes) converted_total += c.value;
+
+    // Выгрузка результатов (NDJSON в отдельный каталог: сериализация и запись)
+    const string export_dir = "benchmark_out";
+    error_code dir_ec;
+    fs::create_directories(export_dir, dir_ec);
+    beginStage(StageWrite);
+    vector<PerThread<unsigned long long>> exported(pool.size());
+    pool.parallelFor(all_data.size(), [&](size_t i, unsigned worker) {
+        string out = export_dir + "/converted_" + to_string(i) + ".ndjson";
+        unsigned long long bytes = 0;
+        if (saveConverted(out, all_data[i].records, 2, ExportFormat::Ndjson, &bytes)) {
+            exported[worker].value += bytes;
+        }
+    });
+    endStage();
+    for (const auto& e : exported) result.export_bytes += e.value;
+
+    for (double ms : result.stage_ms) result.total_time_ms += ms;
+    if (result.total_time_ms > 0) {
+        result.records_per_second = (result.records_processed * 1000.0) / result.total_time_ms;
+    }
+
+    benchmark_results.push_back(result);
+
+    // Вывод результатов
+    ReportSink& report = menuReport();
+    report.begin("benchmark", "");
+    report.section("summary", "РЕЗУЛЬТАТЫ БЕНЧМАРКА");
+    report.count("files", "Файлов обработано:", n);
+    report.count("records", "Записей обработано:", result.records_processed);
+    report.count("input_bytes", "Прочитано байт:", static_cast<long long>(result.input_bytes));
+    report.count("valid", "Корректных записей:", valid_count);
+    report.count("errors", "Записей с ошибками:", error_count);
+    for (int k = 0; k < kBenchmarkStages; k++) {
+        string label = string("Время: ") + kBenchmarkStageNames[k] + ":";
+        report.number(kBenchmarkStageKeys[k], label.c_str(), result.stage_ms[k], " мс");
+    }
+    report.count("converted_bytes", "Конвертировано байт:", static_cast<long long>(converted_total));
+    report.count("out_bytes", "Записано байт:", static_cast<long long>(result.export_bytes));
+    report.number("time_ms", "Общее время:", result.total_time_ms, " мс");
+    report.number("records_per_second", "Записей в секунду:", result.records_per_second);
+    report.end_section();
+
+    reportLatency(report, "latency", "ВРЕМЯ ПРОВЕРКИ ЗАПИСИ (каждая " + to_string(kLatencySample) + "-я)", record_latency);
+
+    // Таблица счетчиков и анализ узкого места: самый долгий этап, а при
+    // наличии счетчиков — на что уходят его такты. Цена промаха оценочная:
+    // ~15 тактов на неверно предсказанное ветвление, ~100 тактов на промах LLC
+    ostringstream analysis;
+    analysis << fixed << setprecision(2);
+    printStageCounters(analysis, result);
+    analysis << "\n=== АНАЛИЗ УЗКОГО МЕСТА ===\n";
+    int slowest = 0;
+    for (int k = 1; k < kBenchmarkStages; k++) {
+        if (result.stage_ms[k] > result.stage_ms[slowest]) slowest = k;
+    }
+    static const char* const kAdvice[kBenchmarkStages] = {
+        "Кэширование (--cache), манифест (--manifest), более быстрый диск",
+        "Кэш разбора (--cache), меньше escape-последовательностей во входе",
+        "Векторизация, меньше ветвлений на ошибочных записях",
+        "Векторизация записи дат",
+        "Более быстрый диск, NDJSON/CSV вместо JSON"
+    };
+    analysis << "Узкое место: " << kBenchmarkStageNames[slowest] << " (" << result.stage_ms[slowest] << " мс)\n";
+    const PerfSample& s = result.stage_counters[slowest];
+    if (s.has(PerfEvent::Cycles) && s[PerfEvent::Cycles] > 0) {
+        double cycles = s[PerfEvent::Cycles];
+        double branch = s.has(PerfEvent::BranchMisses) ? s[PerfEvent::BranchMisses] * 15 / cycles : 0;
+        double memory = s.has(PerfEvent::LlcMisses) ? s[PerfEvent::LlcMisses] * 100 / cycles : 0;
+        analysis << "Оценка потерь тактов: ветвления ~" << min(branch, 1.0) * 100
+            << "%, промахи LLC ~" << min(memory, 1.0) * 100 << "%\n";
+        if (branch > 0.2 && branch >= memory) analysis << "Этап ограничен предсказанием ветвлений\n";
+        else if (memory > 0.2) analysis << "Этап ограничен промахами кэша\n";
+    }
+    analysis << "Рекомендация: " << kAdvice[slowest];
+    report.note(analysis.str());
+    report.end();
+}
+
+void debugMode() {
+    printHeader("РЕЖИМ ОТЛАДКИ");
+
+    cout << "=== ИНФОРМАЦИЯ О СИСТЕМЕ ===\n";
+    cout << "Размер int: " << sizeof(int) << " байт\n";
+    cout << "Размер string: " << sizeof(string) << " байт\n";
+    cout << "Запись в пакете: " << sizeof(TextRef) * 2 + sizeof(int32_t) + sizeof(DateError) << " байт\n";
+    cout << "SIMD-ядро конвертации: " << simdLevelName(simd_level) << "\n";
+
+    // Пробное открытие счетчиков: какие события доступны в этой системе
+    {
+        static const char* const kEventNames[kPerfEventCount] = {
+            "такты", "инструкции", "промахи ветвлений", "промахи L1d", "промахи LLC", "страничные ошибки"
+        };
+        PerfCounters probe;
+        probe.start();
+        PerfSample s = probe.stop();
+        cout << "Аппаратные счетчики:";
+        for (int k = 0; k < kPerfEventCount; k++) {
+            cout << (k ? ", " : " ") << kEventNames[k] << (s.has(static_cast<PerfEvent>(k)) ? " — да" : " — нет");
+        }
+        cout << "\n";
+        if (!probe.unavailable().empty()) cout << "Причина недоступности: " << probe.unavailable() << "\n";
+    }
+
+    cout << "\n=== СОСТОЯНИЕ ПРОГРАММЫ ===\n";
+    cout << "Всего запущено тестов: " << total_tests_run << "\n";
+    cout << "Пройдено тестов: " << passed_tests << "\n";
+    cout << "Результатов бенчмарка: " << benchmark_results.size() << "\n";
+
+    if (!benchmark_results.empty()) {
+        cout << "\n=== ПОСЛЕДНИЙ БЕНЧМАРК ===\n";
+        auto& last = benchmark_results.back();
+        cout << "Записей: " << last.records_processed << "\n";
+        cout << "Общее время: " << last.total_time_ms << " мс\n";
+        cout << "Производительность: " << fixed << setprecision(2) << last.records_per_second << " зап/сек\n";
+        for (int k = 0; k < kBenchmarkStages; k++) {
+            cout << kBenchmarkStageNames[k] << ": " << last.stage_ms[k] << " мс\n";
+        }
+        if (last.counters) printStageCounters(cout, last);
+    }
 
-string iso2mdy(const string& iso) {
-    if (!validISO(iso)) return "";
-    return iso.substr(5, 2) + "/" + iso.substr(8, 2) + "/" + iso.substr(0, 4);
+    cout << "\n=== ФАЙЛЫ В ПАПКЕ ===\n";
+    cout.flush();  // вывод system() идет мимо буфера cout
+    system("dir *.json 2>nul || ls *.json 2>/dev/null || echo 'Не удалось получить список файлов'");
 }
 
-vector<DateRecord> loadDates(const string& fname) {
-    vector<DateRecord> res;
-    ifstream f(fname);
-    if (!f.is_open()) {
-        return res;
-    }
+// ===================== ПАКЕТНЫЙ РЕЖИМ =====================
+// Запуск без меню: date_convertor <команда> [опции]. Все входные файлы
+// обрабатываются одним процессом, в stdout выводится одна строка итога.
 
-    string line;
-    while (getline(f, line)) {
-        if (line.find('{') != string::npos) {
-            DateRecord dr;
-            dr.has_error = false;
-
-            size_t name_pos = line.find("\"name\":");
-            if (name_pos != string::npos) {
-                name_pos = line.find('\"', name_pos + 7);
-                if (name_pos != string::npos) {
-                    size_t name_end = line.find('\"', name_pos + 1);
-                    if (name_end != string::npos) {
-                        dr.name = line.substr(name_pos + 1, name_end - name_pos - 1);
-                    }
-                }
-            }
+struct BatchOptions {
+    string command;
+    int mode = 2;               // 2 = DD.MM.YYYY, 3 = MM/DD/YYYY
+    vector<string> inputs;
+    string out_dir;
+    ExportFormat out_format = ExportFormat::Json;
+    int count = 0;
+    int error_percent = 30;
+    unsigned threads = 0;       // 0 — по числу ядер
+    bool stream = false;        // все файлы читаются потоково (иначе только крупные)
+    bool cache = false;         // кэш разбора рядом с исходными файлами
+    string manifest;            // манифест итогов для повторного анализа
+    string socket_path = kServeDefaultSocket;  // serve, client, loadgen
+    unsigned batch_us = kServeDefaultWindowUs; // окно сбора пакета (serve)
+    bool stats = false;         // запрос статистики сервера (client)
+    int connections = 4;        // соединений (loadgen)
+    int requests = 10000;       // запросов всего (loadgen)
+    int dates = 10;             // дат в запросе (loadgen)
+    int records = 10;           // записей в файле (generate)
+    ReportFormat report = ReportFormat::Line;  // формат итога
+    bool has_report = false;
+    bool verbose = false;       // строки по каждому файлу (generate, меню)
+    bool has_seed = false;
+    uint64_t seed = 0;
+    array<unsigned, kGeneratorErrorKinds> error_weights = GeneratorConfig().error_weights;
+    array<unsigned, kGeneratorFormats> format_weights = GeneratorConfig().format_weights;
+};
 
-            size_t date_pos = line.find("\"date_iso\":");
-            if (date_pos != string::npos) {
-                date_pos = line.find('\"', date_pos + 11);
-                if (date_pos != string::npos) {
-                    size_t date_end = line.find('\"', date_pos + 1);
-                    if (date_end != string::npos) {
-                        dr.iso = line.substr(date_pos + 1, date_end - date_pos - 1);
-                    }
-                }
+// Разбор --mix код=вес,...; коды — как в итоговой строке (wrong_separator и т.д.)
+bool parseErrorMix(const string& spec, array<unsigned, kGeneratorErrorKinds>& weights) {
+    weights.fill(0);
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == string::npos) return false;
+        string code = item.substr(0, eq);
+        bool known = false;
+        for (int k = 0; k < kGeneratorErrorKinds; k++) {
+            if (code == dateErrorCode(static_cast<DateError>(k + 1))) {
+                weights[k] = static_cast<unsigned>(max(0, atoi(item.c_str() + eq + 1)));
+                known = true;
             }
+        }
+        if (!known) return false;
+    }
+    return true;
+}
 
-            if (dr.name.empty() || dr.iso.empty()) {
-                dr.has_error = true;
+// Разбор --formats формат=вес,...; форматы — iso, dmy, mdy, text
+bool parseFormatMix(const string& spec, array<unsigned, kGeneratorFormats>& weights) {
+    weights.fill(0);
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == string::npos) return false;
+        string name = item.substr(0, eq);
+        bool known = false;
+        for (int f = 0; f < kGeneratorFormats; f++) {
+            if (name == kGeneratorFormatNames[f]) {
+                weights[f] = static_cast<unsigned>(max(0, atoi(item.c_str() + eq + 1)));
+                known = true;
             }
-
-            res.push_back(dr);
         }
+        if (!known) return false;
     }
-
-    return res;
+    unsigned sum = 0;
+    for (unsigned w : weights) sum += w;
+    return sum > 0;
 }
 
-void generateMixedFiles(int n, int error_percentage = 30) {
-    srand(static_cast<unsigned int>(time(nullptr)));
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> error_dist(0, 100);
-    uniform_int_distribution<> error_type_dist(0, 9);
-
-    int correct_files = 0;
-    int error_files = 0;
+void batchUsage() {
+    cerr << "Использование:\n"
+        << "  date_convertor convert --format dmy|mdy --in <файл|каталог>... [--out <каталог>]\n"
+        << "                         [--out-format json|ndjson|csv] [--threads N] [--stream] [--cache]\n"
+        << "  date_convertor analyze --in <файл|каталог>... [--threads N] [--stream] [--cache]\n"
+        << "                         [--manifest <файл>]\n"
+        << "  date_convertor generate --count N [--records N] [--errors 0-100] [--seed S]\n"
+        << "                          [--mix wrong_separator=2,missing_field=1,...]\n"
+        << "                          [--formats iso=6,dmy=2,mdy=1,text=1] [--out <каталог>]\n"
+        << "  date_convertor serve [--socket <путь>] [--batch-us N]\n"
+        << "  date_convertor client [--socket <путь>] [--format dmy|mdy] [--stats] [дата...]\n"
+        << "  date_convertor loadgen [--socket <путь>] [--format dmy|mdy] [--connections N]\n"
+        << "                         [--requests N] [--dates N] [--errors 0-100] [--seed S]\n"
+        << "  date_convertor selftest\n"
+        << "  date_convertor menu [--report text|json|quiet] [--verbose] [--cache]\n"
+        << "convert, analyze и generate принимают --report line|text|json|quiet (по умолчанию\n"
+        << "line — одна строка key=value) и --verbose (generate: строка на каждый файл).\n"
+        << "Без аргументов запускается интерактивное меню.\n";
+}
 
-    for (int i = 0; i < n; i++) {
-        simple_json::array arr;
-        bool file_has_errors = false;
-        int error_count = 0;
-        int correct_count = 0;
-
-        for (int j = 0; j < 10; j++) {
-            simple_json::object obj;
-            
-            // Решаем, будет ли эта запись с ошибкой
-            bool make_error = (error_dist(gen) < error_percentage);
-            
-            if (make_error) {
-                file_has_errors = true;
-                error_count++;
-                obj.add("name", "error_record_" + to_string(i) + "_" + to_string(j));
-                
-                int error_type = error_type_dist(gen);
-                string bad_date;
-                
-                switch (error_type % 8) {
-                    case 0: bad_date = "2024/12/31"; break;  // неправильный разделитель
-                    case 1: bad_date = "31-12-2024"; break;  // европейский формат
-                    case 2: bad_date = "2024-13-45"; break;  // несуществующий месяц/день
-                    case 3: bad_date = "abcd-ef-gh"; break;  // некорректные символы
-                    case 4: bad_date = "2024-12"; break;     // неполная дата
-                    case 5: bad_date = ""; break;           // пустая строка
-                    case 6: bad_date = "2024-12-31-extra"; break;  // лишние символы
-                    case 7: 
-                        // пропущенное поле date_iso
-                        obj.add("name", "error_record_" + to_string(i) + "_" + to_string(j));
-                        // не добавляем date_iso
-                        arr.add(obj);
-                        continue;
-                }
-                
-                if (!bad_date.empty() && error_type != 7) {
-                    obj.add("date_iso", bad_date);
-                }
-            } else {
-                correct_count++;
-                int y = 2000 + rand() % 25;
-                int m = 1 + rand() % 12;
-                int d;
-
-                if (m == 2) {
-                    bool isLeap = (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0);
-                    d = 1 + rand() % (isLeap ? 29 : 28);
-                }
-                else if (m == 4 || m == 6 || m == 9 || m == 11) {
-                    d = 1 + rand() % 30;
-                }
-                else {
-                    d = 1 + rand() % 31;
+// Разворачивает каталоги в список *.json файлов: входы в порядке аргументов,
+// файлы каталога — по имени. Файл, переданный повторно (сам и через свой
+// каталог), остается один раз
+vector<string> collectInputs(const vector<string>& inputs) {
+    vector<string> files;
+    unordered_set<string> seen;
+    auto add = [&](string path) {
+        if (seen.insert(fs::path(path).lexically_normal().string()).second) files.push_back(move(path));
+    };
+    for (const auto& in : inputs) {
+        error_code ec;
+        if (fs::is_directory(in, ec)) {
+            vector<string> dir_files;
+            for (const auto& entry : fs::directory_iterator(in, ec)) {
+                if (entry.is_regular_file(ec) && entry.path().extension() == ".json") {
+                    dir_files.push_back(entry.path().string());
                 }
-
-                string month_str = (m < 10) ? "0" + to_string(m) : to_string(m);
-                string day_str = (d < 10) ? "0" + to_string(d) : to_string(d);
-
-                string iso = to_string(y) + "-" + month_str + "-" + day_str;
-
-                obj.add("name", "record_" + to_string(i) + "_" + to_string(j));
-                obj.add("date_iso", iso);
             }
-            
-            arr.add(obj);
-        }
-
-        string filename;
-        string file_type;
-        
-        if (file_has_errors) {
-            filename = "mixed_data_" + to_string(i) + ".json";
-            file_type = "СМЕШАННЫЙ (ошибок: " + to_string(error_count) + ")";
-            error_files++;
-        } else {
-            filename = "correct_data_" + to_string(i) + ".json";
-            file_type = "КОРРЕКТНЫЙ";
-            correct_files++;
+            sort(dir_files.begin(), dir_files.end());
+            for (auto& f : dir_files) add(move(f));
         }
-        
-        ofstream file(filename);
-        if (file) {
-            file << arr.dump();
-            cout << "Создан " << file_type << " файл: " << filename 
-                 << " (корректных: " << correct_count 
-                 << ", ошибок: " << error_count << ")" << endl;
+        else {
+            add(in);
         }
     }
-    
-    cout << "\n=== СВОДКА ГЕНЕРАЦИИ ===\n";
-    cout << "Всего создано файлов: " << n << endl;
-    cout << "Корректных файлов: " << correct_files << endl;
-    cout << "Файлов с ошибками: " << error_files << endl;
-    cout << "Процент ошибок в смешанных файлах: " << error_percentage << "%\n";
+    return files;
 }
 
-void convert(int mode) {
-    cout << "Имя файла: ";
-    string fname;
-    cin >> fname;
-
-    auto start_load = chrono::high_resolution_clock::now();
-    auto data = loadDates(fname);
-    auto end_load = chrono::high_resolution_clock::now();
-
-    if (data.empty()) {
-        cout << "Файл пуст или не найден!\n";
-        return;
-    }
-
-    auto start_convert = chrono::high_resolution_clock::now();
-    int cnt = 0;
-    int errors = 0;
-    int correct_dates = 0;
-
-    printHeader("РЕЗУЛЬТАТЫ КОНВЕРТАЦИИ");
-
-    // Расчет статистики
-    vector<int> processing_times;
-    int valid_count = 0;
+bool parseBatchArgs(int argc, char* argv[], BatchOptions& opt) {
+    opt.command = argv[1];
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
 
-    for (auto& dr : data) {
-        auto start_record = chrono::high_resolution_clock::now();
-
-        if (dr.has_error) {
-            errors++;
+        if (arg == "--format" && has_value) {
+            string fmt = argv[++i];
+            if (fmt == "dmy") opt.mode = 2;
+            else if (fmt == "mdy") opt.mode = 3;
+            else return false;
         }
-        else if (mode == 2 && validISO(dr.iso)) {  // ISO->DD.MM.YYYY
-            dr.dmy = iso2dmy(dr.iso);
-            cnt++;
-            valid_count++;
-            correct_dates++;
+        else if (arg == "--in" && has_value) {
+            opt.inputs.push_back(argv[++i]);
         }
-        else if (mode == 3 && validISO(dr.iso)) {  // ISO->MM/DD/YYYY
-            dr.mdy = iso2mdy(dr.iso);
-            cnt++;
-            valid_count++;
-            correct_dates++;
+        else if (arg == "--out" && has_value) {
+            opt.out_dir = argv[++i];
         }
-        else if (!dr.iso.empty()) {
-            errors++;
+        else if (arg == "--out-format" && has_value) {
+            if (!parseExportFormat(argv[++i], opt.out_format)) return false;
         }
-
-        auto end_record = chrono::high_resolution_clock::now();
-        processing_times.push_back(chrono::duration_cast<chrono::microseconds>(end_record - start_record).count());
-    }
-
-    auto end_convert = chrono::high_resolution_clock::now();
-
-    // Расчет статистики
-    if (!processing_times.empty()) {
-        sort(processing_times.begin(), processing_times.end());
-        long long min_time = processing_times.front();
-        long long max_time = processing_times.back();
-        double avg_time = accumulate(processing_times.begin(), processing_times.end(), 0.0) / processing_times.size();
-
-        double median_time;
-        size_t size = processing_times.size();
-        if (size % 2 == 0) {
-            median_time = (processing_times[size / 2 - 1] + processing_times[size / 2]) / 2.0;
+        else if (arg == "--count" && has_value) {
+            opt.count = atoi(argv[++i]);
         }
-        else {
-            median_time = processing_times[size / 2];
+        else if (arg == "--errors" && has_value) {
+            opt.error_percent = clamp(atoi(argv[++i]), 0, 100);
         }
-
-        // Обнаружение аномалий (больше чем 3 стандартных отклонения от среднего)
-        double sum_sq = 0;
-        for (auto t : processing_times) {
-            sum_sq += (t - avg_time) * (t - avg_time);
+        else if (arg == "--records" && has_value) {
+            opt.records = max(1, atoi(argv[++i]));
         }
-        double std_dev = sqrt(sum_sq / processing_times.size());
-        double threshold = avg_time + 3 * std_dev;
-
-        int anomalies = 0;
-        for (auto t : processing_times) {
-            if (t > threshold) anomalies++;
+        else if (arg == "--seed" && has_value) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+            opt.has_seed = true;
+        }
+        else if (arg == "--mix" && has_value) {
+            if (!parseErrorMix(argv[++i], opt.error_weights)) return false;
+        }
+        else if (arg == "--formats" && has_value) {
+            if (!parseFormatMix(argv[++i], opt.format_weights)) return false;
+        }
+        else if (arg == "--stream") {
+            opt.stream = true;
+        }
+        else if (arg == "--cache") {
+            opt.cache = true;
+        }
+        else if (arg == "--manifest" && has_value) {
+            opt.manifest = argv[++i];
+        }
+        else if (arg == "--socket" && has_value) {
+            opt.socket_path = argv[++i];
+        }
+        else if (arg == "--batch-us" && has_value) {
+            opt.batch_us = static_cast<unsigned>(max(0, atoi(argv[++i])));
+        }
+        else if (arg == "--stats") {
+            opt.stats = true;
+        }
+        else if (arg == "--connections" && has_value) {
+            opt.connections = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--requests" && has_value) {
+            opt.requests = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--dates" && has_value) {
+            opt.dates = clamp(atoi(argv[++i]), 1, 10000);
+        }
+        else if (arg == "--threads" && has_value) {
+            opt.threads = static_cast<unsigned>(max(0, atoi(argv[++i])));
+        }
+        else if (arg == "--report" && has_value) {
+            if (!parseReportFormat(argv[++i], opt.report)) return false;
+            opt.has_report = true;
+        }
+        else if (arg == "--verbose") {
+            opt.verbose = true;
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            return false;
+        }
+        else {
+            opt.inputs.push_back(arg);
         }
-
-        // Вывод статистики
-        cout << "\n=== СТАТИСТИКА ВРЕМЕНИ ОБРАБОТКИ ===\n";
-        cout << left << setw(25) << "Минимальное время:" << min_time << " мкс\n";
-        cout << left << setw(25) << "Максимальное время:" << max_time << " мкс\n";
-        cout << left << setw(25) << "Среднее время:" << fixed << setprecision(2) << avg_time << " мкс\n";
-        cout << left << setw(25) << "Медиана:" << fixed << setprecision(2) << median_time << " мкс\n";
-        cout << left << setw(25) << "Найдено аномалий:" << anomalies << " записей\n";
-        cout << left << setw(25) << "Порог аномалий:" << fixed << setprecision(2) << threshold << " мкс\n";
     }
+    return true;
+}
 
-    auto load_time = chrono::duration_cast<chrono::milliseconds>(end_load - start_load);
-    auto convert_time = chrono::duration_cast<chrono::milliseconds>(end_convert - start_convert);
-    auto total_time = load_time + convert_time;
+// Итог пакетной конвертации; время этапов суммируется по потокам
+struct BatchConvertTotals {
+    size_t records = 0;
+    long long converted = 0;
+    long long errors = 0;
+    int failed_files = 0;
+    ErrorCounts error_kinds;
+    long long load_us = 0;
+    long long convert_us = 0;
+    long long write_us = 0;
+    unsigned long long out_bytes = 0;
 
-    cout << "\n=== СВОДКА ===\n";
-    cout << left << setw(30) << "Всего записей:" << data.size() << endl;
-    cout << left << setw(30) << "Корректных дат:" << correct_dates << endl;
-    cout << left << setw(30) << "Конвертировано:" << cnt << endl;
-    cout << left << setw(30) << "Найдено ошибок:" << errors << endl;
-    cout << left << setw(30) << "Время загрузки:" << load_time.count() << " мс\n";
-    cout << left << setw(30) << "Время конвертации:" << convert_time.count() << " мс\n";
-    cout << left << setw(30) << "Общее время:" << total_time.count() << " мс\n";
+    void merge(const BatchConvertTotals& o) {
+        records += o.records;
+        converted += o.converted;
+        errors += o.errors;
+        failed_files += o.failed_files;
+        error_kinds.merge(o.error_kinds);
+        load_us += o.load_us;
+        convert_us += o.convert_us;
+        write_us += o.write_us;
+        out_bytes += o.out_bytes;
+    }
+};
 
-    if (total_time.count() > 0) {
-        double records_per_second = (data.size() * 1000.0) / total_time.count();
-        cout << left << setw(30) << "Записей в секунду:" << fixed << setprecision(2) << records_per_second << endl;
+// Файл результата для входа fname: каталог --out, имя входа с расширением формата
+string outputPath(const BatchOptions& opt, const string& fname) {
+    fs::path out = fs::path(opt.out_dir) / fs::path(fname).filename();
+    out.replace_extension(exportExtension(opt.out_format));
+    return out.string();
+}
+
+// Файлы распределяются по потокам пула целиком: пока один поток пишет
+// результат своего файла, остальные конвертируют следующие, а конвейер
+// чтения уже читает файлы после них. Крупные файлы (или все при --stream)
+// обрабатываются потоково после остальных
+int batchConvert(const BatchOptions& opt) {
+    vector<string> all_files = collectInputs(opt.inputs);
+    if (all_files.empty()) {
+        cerr << "Не заданы входные файлы\n";
+        return 1;
     }
-    
-    // Вывод примера конвертации
-    cout << "\n=== ПРИМЕР КОНВЕРТАЦИИ ===\n";
-    int examples_shown = 0;
-    for (const auto& dr : data) {
-        if (examples_shown >= 3) break;
-        if (!dr.iso.empty() && validISO(dr.iso)) {
-            if (mode == 2) {
-                cout << dr.iso << " -> " << iso2dmy(dr.iso) << endl;
-            } else if (mode == 3) {
-                cout << dr.iso << " -> " << iso2mdy(dr.iso) << endl;
+    // Результаты пишутся в один каталог по имени входа: входы с одинаковым
+    // именем из разных каталогов перезаписали бы друг друга
+    if (!opt.out_dir.empty()) {
+        unordered_map<string, const string*> outputs;
+        for (const auto& fname : all_files) {
+            auto [it, added] = outputs.emplace(outputPath(opt, fname), &fname);
+            if (!added) {
+                cerr << "Файлы " << *it->second << " и " << fname << " дают один результат " << it->first << "\n";
+                return 1;
             }
-            examples_shown++;
         }
     }
-}
-
-void analyze() {
-    cout << "Сколько файлов проанализировать? ";
-    int n;
-    cin >> n;
+    if (!opt.out_dir.empty()) {
+        error_code ec;
+        fs::create_directories(opt.out_dir, ec);
+    }
 
-    if (n <= 0) return;
+    auto us_since = [](chrono::high_resolution_clock::time_point from) {
+        return static_cast<long long>(chrono::duration_cast<chrono::microseconds>(
+            chrono::high_resolution_clock::now() - from).count());
+    };
 
-    int total = 0, valid = 0, errors = 0;
-    int mixed_files = 0, correct_files = 0, error_files = 0;
-    vector<long long> processing_times;
+    // Проверка и выгрузка загруженного файла; cache_stamp — записи только что
+    // разобраны из JSON и для них пишется кэш (отметка снята до чтения);
+    // cached — записи взяты из кэша уже проверенными, это их итог
+    auto process = [&](DateFile& file, const string& fname, BatchConvertTotals& t,
+        const SourceStamp* cache_stamp, const ConvertStats* cached) {
+        auto& data = file.records;
+        if (data.empty()) {
+            t.failed_files++;
+            return;
+        }
 
-    for (int i = 0; i < n; i++) {
-        auto start = chrono::high_resolution_clock::now();
+        auto stage = chrono::high_resolution_clock::now();
+        ConvertStats st = cached ? *cached : convertRecordsParallel(data);
+        t.convert_us += us_since(stage);
+        t.records += data.size();
+        t.converted += st.converted;
+        t.errors += st.errors;
+        t.error_kinds.merge(st.error_kinds);
 
-        // Пробуем разные имена файлов
-        string filename;
-        bool file_found = false;
-        
-        // Пробуем mixed_data
-        filename = "mixed_data_" + to_string(i) + ".json";
-        ifstream test1(filename);
-        if (test1.good()) {
-            file_found = true;
-            mixed_files++;
-        }
-        
-        // Пробуем correct_data
-        if (!file_found) {
-            filename = "correct_data_" + to_string(i) + ".json";
-            ifstream test2(filename);
-            if (test2.good()) {
-                file_found = true;
-                correct_files++;
-            }
-        }
-        
-        // Пробуем data_ (старый формат)
-        if (!file_found) {
-            filename = "data_" + to_string(i) + ".json";
-            ifstream test3(filename);
-            if (test3.good()) {
-                file_found = true;
-                correct_files++;
-            }
-        }
-        
-        // Пробуем error_data_ (старый формат)
-        if (!file_found) {
-            filename = "error_data_" + to_string(i) + ".json";
-            ifstream test4(filename);
-            if (test4.good()) {
-                file_found = true;
-                error_files++;
-            }
-        }
-
-        if (!file_found) {
-            cout << "Файл с индексом " << i << " не найден, пропускаем...\n";
-            continue;
+        stage = chrono::high_resolution_clock::now();
+        if (cache_stamp) writeDateCache(fname, *cache_stamp, data, file.malformed);
+        if (!opt.out_dir.empty()) {
+            unsigned long long bytes = 0;
+            if (!saveConverted(outputPath(opt, fname), data, opt.mode, opt.out_format, &bytes)) t.failed_files++;
+            t.out_bytes += bytes;
         }
+        t.write_us += us_since(stage);
+    };
 
-        auto data = loadDates(filename);
-        auto end = chrono::high_resolution_clock::now();
-        processing_times.push_back(chrono::duration_cast<chrono::milliseconds>(end - start).count());
+    auto start = chrono::high_resolution_clock::now();
+    WorkStealingPool& pool = sharedPool();
+    vector<PerThread<BatchConvertTotals>> partial(pool.size());
 
-        if (!data.empty()) {
-            total += data.size();
-            for (auto& dr : data) {
-                if (validISO(dr.iso)) {
-                    valid++;
-                }
-                else {
-                    errors++;
-                }
-            }
+    // Файлы с действительным кэшем берутся из него, без чтения и разбора JSON;
+    // для остальных отметка нового кэша снимается до чтения
+    vector<char> cached(all_files.size(), 0);
+    vector<SourceStamp> stamps(opt.cache ? all_files.size() : 0);
+    vector<char> cache_stamped(stamps.size(), 0);
+    if (opt.cache) {
+        pool.parallelFor(all_files.size(), [&](size_t i, unsigned worker) {
+            auto stage = chrono::high_resolution_clock::now();
+            if (!sourceStamp(all_files[i], stamps[i].size, stamps[i].mtime)) return;
+            cache_stamped[i] = 1;
+            DateCache cache;
+            if (!cache.open(all_files[i])) return;
+            ConvertStats cache_st = cache.stats();
+            DateFile file = cache.take();
+            partial[worker].value.load_us += us_since(stage);
+            cached[i] = 1;
+            process(file, all_files[i], partial[worker].value, nullptr, &cache_st);
+        });
+    }
+
+    vector<string> files, streamed;
+    vector<size_t> file_index;  // номер files[j] в all_files
+    for (size_t i = 0; i < all_files.size(); i++) {
+        if (cached[i]) continue;
+        if (useStream(all_files[i], opt.stream)) {
+            streamed.push_back(all_files[i]);
+        }
+        else {
+            files.push_back(all_files[i]);
+            file_index.push_back(i);
         }
     }
 
-    printHeader("РЕЗУЛЬТАТЫ АНАЛИЗА");
+    FilePrefetcher prefetch(files, prefetchDepth(pool.size()));
+    forEachFile(pool, files.size(), [&](size_t, unsigned worker) {
+        BatchConvertTotals& t = partial[worker].value;
 
-    if (!processing_times.empty()) {
-        cout << "\n=== ПРОИЗВОДИТЕЛЬНОСТЬ ===\n";
-        long long min_time = *min_element(processing_times.begin(), processing_times.end());
-        long long max_time = *max_element(processing_times.begin(), processing_times.end());
-        double avg_time = accumulate(processing_times.begin(), processing_times.end(), 0.0) / processing_times.size();
+        // load_ms включает ожидание чтения: это время, не скрытое конвейером
+        auto stage = chrono::high_resolution_clock::now();
+        PrefetchedFile f;
+        if (!prefetch.next(f)) return;
+        DateFile file = parsePrefetched(f);
+        t.load_us += us_since(stage);
+        size_t i = file_index[f.index];
+        process(file, files[f.index], t, opt.cache && cache_stamped[i] ? &stamps[i] : nullptr, nullptr);
+        prefetch.release(f);
+    });
 
-        cout << left << setw(25) << "Минимальное время:" << min_time << " мс\n";
-        cout << left << setw(25) << "Максимальное время:" << max_time << " мс\n";
-        cout << left << setw(25) << "Среднее время:" << fixed << setprecision(2) << avg_time << " мс\n";
-    }
+    BatchConvertTotals total;
+    for (const auto& p : partial) total.merge(p.value);
 
-    cout << "\n=== ДАННЫЕ ===\n";
-    cout << left << setw(25) << "Проверено файлов:" << n << endl;
-    cout << left << setw(25) << "Смешанных файлов:" << mixed_files << endl;
-    cout << left << setw(25) << "Корректных файлов:" << correct_files << endl;
-    cout << left << setw(25) << "Файлов с ошибками:" << error_files << endl;
-    cout << left << setw(25) << "Всего записей:" << total << endl;
-    cout << left << setw(25) << "Корректных дат:" << valid << endl;
-    cout << left << setw(25) << "Ошибок:" << errors << endl;
+    for (const auto& fname : streamed) {
+        string out_name = opt.out_dir.empty() ? string() : outputPath(opt, fname);
+        StreamStats ss = streamConvert(fname, out_name, opt.mode, opt.out_format, true);
+        total.load_us += ss.load_us;
+        total.convert_us += ss.convert_us;
+        total.write_us += ss.write_us;
+        if (ss.records == 0 || !ss.saved) total.failed_files++;
+        total.records += ss.records;
+        total.converted += ss.convert.converted;
+        total.errors += ss.convert.errors;
+        total.error_kinds.merge(ss.convert.error_kinds);
+        total.out_bytes += ss.out_bytes;
+    }
 
-    if (total > 0) {
-        cout << left << setw(25) << "Процент корректных:"
-            << fixed << setprecision(1) << (valid * 100.0 / total) << "%" << endl;
-        cout << left << setw(25) << "Процент ошибок:"
-            << fixed << setprecision(1) << (errors * 100.0 / total) << "%" << endl;
+    auto end = chrono::high_resolution_clock::now();
+    unique_ptr<ReportSink> report = makeReport(opt.report);
+    report->begin("convert", "РЕЗУЛЬТАТЫ КОНВЕРТАЦИИ");
+    report->count("files", "Файлов:", static_cast<long long>(all_files.size()));
+    report->count("failed", "Не обработано файлов:", total.failed_files);
+    report->count("records", "Всего записей:", static_cast<long long>(total.records));
+    report->count("converted", "Конвертировано:", total.converted);
+    report->count("errors", "Найдено ошибок:", total.errors);
+    if (total.errors > 0) reportErrorCounts(*report, total.error_kinds);
+    report->count("load_ms", "Время загрузки:", total.load_us / 1000, " мс");
+    report->count("convert_ms", "Время конвертации:", total.convert_us / 1000, " мс");
+    report->count("write_ms", "Время записи:", total.write_us / 1000, " мс");
+    report->count("out_bytes", "Записано байт:", static_cast<long long>(total.out_bytes));
+    if (total.write_us > 0) {
+        report->number("write_mb_s", "Скорость записи (МБ/с):", static_cast<double>(total.out_bytes) / total.write_us, "", 1);
     }
+    report->count("time_ms", "Общее время:", chrono::duration_cast<chrono::milliseconds>(end - start).count(), " мс");
+    report->end();
+    return total.failed_files > 0 ? 2 : 0;
 }
 
-void runSelfTests() {
-    printHeader("ЗАПУСК САМОТЕСТОВ");
-    total_tests_run = 0;
-    passed_tests = 0;
-
-    printTableHeader();
+int batchAnalyze(const BatchOptions& opt) {
+    vector<string> files = collectInputs(opt.inputs);
+    if (files.empty()) {
+        cerr << "Не заданы входные файлы\n";
+        return 1;
+    }
 
-    // Тест 1: Валидация корректных дат
-    total_tests_run++;
     auto start = chrono::high_resolution_clock::now();
-    bool test1 = validISO("2024-12-31") && validISO("2000-01-01") && validISO("2024-02-29");
+    AnalyzeOptions options;
+    options.stream_all = opt.stream;
+    options.use_cache = opt.cache;
+    AnalyzeManifest manifest;
+    if (!opt.manifest.empty()) {
+        manifest.load(opt.manifest);
+        options.manifest = &manifest;
+    }
+    AnalyzeStats st = analyzeFiles(files, options);
+    if (options.manifest && !manifest.save(opt.manifest)) {
+        cerr << "Не удалось сохранить манифест " << opt.manifest << "\n";
+    }
     auto end = chrono::high_resolution_clock::now();
-    auto time1 = chrono::duration_cast<chrono::microseconds>(end - start).count();
-
-    if (test1) passed_tests++;
-    cout << left << setw(20) << "Валидация корректных"
-        << setw(15) << "3"
-        << setw(15) << time1
-        << setw(15) << (test1 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << endl;
-
-    // Тест 2: Валидация некорректных дат
-    total_tests_run++;
-    start = chrono::high_resolution_clock::now();
-    bool test2 = !validISO("2024-13-31") && !validISO("2024-12-32") && !validISO("abcd-ef-gh");
-    end = chrono::high_resolution_clock::now();
-    auto time2 = chrono::duration_cast<chrono::microseconds>(end - start).count();
-
-    if (test2) passed_tests++;
-    cout << left << setw(20) << "Валидация ошибок"
-        << setw(15) << "3"
-        << setw(15) << time2
-        << setw(15) << (test2 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << endl;
-
-    // Тест 3: Конвертация форматов
-    total_tests_run++;
-    start = chrono::high_resolution_clock::now();
-    bool test3 = (iso2dmy("2024-12-31") == "31.12.2024") &&
-        (iso2mdy("2024-12-31") == "12/31/2024");
-    end = chrono::high_resolution_clock::now();
-    auto time3 = chrono::duration_cast<chrono::microseconds>(end - start).count();
-
-    if (test3) passed_tests++;
-    cout << left << setw(20) << "Конвертация"
-        << setw(15) << "2"
-        << setw(15) << time3
-        << setw(15) << (test3 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << endl;
-
-    // Тест 4: Генерация смешанных файлов
-    total_tests_run++;
-    start = chrono::high_resolution_clock::now();
-    generateMixedFiles(1, 30);  // Создаем 1 файл для теста
-    ifstream test_file1("mixed_data_0.json");
-    ifstream test_file2("correct_data_0.json");
-    bool test4 = test_file1.good() || test_file2.good();
-    end = chrono::high_resolution_clock::now();
-    auto time4 = chrono::duration_cast<chrono::milliseconds>(end - start).count();
-
-    if (test4) passed_tests++;
-    cout << left << setw(20) << "Генерация файлов"
-        << setw(15) << "1"
-        << setw(15) << time4
-        << setw(15) << (test4 ? "ПРОЙДЕН" : "НЕ ПРОЙДЕН") << endl;
 
-    cout << string(65, '-') << endl;
-    cout << "\nИТОГО: " << passed_tests << "/" << total_tests_run << " тестов пройдено\n";
-    cout << "УСПЕШНОСТЬ: " << fixed << setprecision(1)
-        << (passed_tests * 100.0 / total_tests_run) << "%\n";
+    unique_ptr<ReportSink> report = makeReport(opt.report);
+    report->begin("analyze", "РЕЗУЛЬТАТЫ АНАЛИЗА");
+    report->count("files", "Проверено файлов:", st.files);
+    report->count("mixed", "Смешанных файлов:", st.mixed_files);
+    report->count("correct", "Корректных файлов:", st.correct_files);
+    report->count("malformed", "Повреждённый JSON:", st.malformed_files);
+    report->count("records", "Всего записей:", st.total);
+    report->count("valid", "Корректных дат:", st.valid);
+    report->count("errors", "Ошибок:", st.errors);
+    if (st.errors > 0) reportErrorCounts(*report, st.error_kinds);
+    if (options.manifest) report->count("unchanged", "Без изменений:", st.unchanged_files);
+    report->count("time_ms", "Общее время:", chrono::duration_cast<chrono::milliseconds>(end - start).count(), " мс");
+    report->end();
+    return 0;
 }
 
-void runBenchmark() {
-    printHeader("БЕНЧМАРК ПРОИЗВОДИТЕЛЬНОСТИ");
-
-    cout << "Сколько файлов для теста? ";
-    int n;
-    cin >> n;
+int batchGenerate(const BatchOptions& opt) {
+    if (opt.count <= 0) {
+        cerr << "Не задано количество файлов (--count)\n";
+        return 1;
+    }
+    if (!opt.out_dir.empty()) {
+        error_code ec;
+        fs::create_directories(opt.out_dir, ec);
+    }
 
-    if (n <= 0) return;
+    GeneratorConfig cfg;
+    cfg.files = opt.count;
+    cfg.records_per_file = opt.records;
+    cfg.error_percent = opt.error_percent;
+    cfg.error_weights = opt.error_weights;
+    cfg.format_weights = opt.format_weights;
+    cfg.seed = opt.has_seed ? opt.seed : randomSeed();
+    cfg.out_dir = opt.out_dir;
 
-    // Создаем тестовые файлы (смешанные)
-    generateMixedFiles(n, 30);  // 30% ошибок
+    unique_ptr<ReportSink> report = makeReport(opt.report);
+    report->begin("generate", "ГЕНЕРАЦИЯ КОРПУСА");
+    auto start = chrono::high_resolution_clock::now();
+    GenerateStats st = generateCorpus(cfg, opt.verbose ? report.get() : nullptr);
+    auto end = chrono::high_resolution_clock::now();
+    reportGenerate(*report, cfg, st, chrono::duration_cast<chrono::milliseconds>(end - start).count());
+    report->end();
+    return 0;
+}
 
-    BenchmarkResult result;
-    result.records_processed = 0;
+#ifndef _WIN32
 
-    auto total_start = chrono::high_resolution_clock::now();
+int batchServe(const BatchOptions& opt) {
+    installServeSignals();
+    ConvertServer server(opt.batch_us);
+    if (!server.listen(opt.socket_path)) {
+        cerr << "Не удалось открыть сокет " << opt.socket_path << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    cerr << "Сервер слушает " << opt.socket_path << " (окно пакета " << opt.batch_us << " мкс)\n";
+    server.run();
+    cout << server.statistics().line() << "\n";
+    return 0;
+}
 
-    // Тест загрузки
-    auto load_start = chrono::high_resolution_clock::now();
-    vector<vector<DateRecord>> all_data;
-    for (int i = 0; i < n; i++) {
-        // Пробуем разные имена файлов
-        string filename;
-        
-        filename = "mixed_data_" + to_string(i) + ".json";
-        ifstream test1(filename);
-        if (!test1.good()) {
-            filename = "correct_data_" + to_string(i) + ".json";
-        }
-        
-        auto data = loadDates(filename);
-        if (!data.empty()) {
-            all_data.push_back(data);
-            result.records_processed += data.size();
-        }
+// Даты из аргументов или построчно из stdin; ответ — строка на дату:
+// исходная строка, табуляция, дата в новом формате или код ошибки
+int batchClient(const BatchOptions& opt) {
+    signal(SIGPIPE, SIG_IGN);
+    ConvertClient client;
+    if (!client.connect(opt.socket_path)) {
+        cerr << "Нет соединения с " << opt.socket_path << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    string body;
+    if (opt.stats) {
+        if (!client.request(statsRequest(), body)) return 1;
+        cout << body.substr(1) << "\n";
+        return 0;
     }
-    auto load_end = chrono::high_resolution_clock::now();
-    result.load_time_ms = chrono::duration_cast<chrono::milliseconds>(load_end - load_start).count();
 
-    // Тест конвертации
-    auto convert_start = chrono::high_resolution_clock::now();
-    int converted = 0;
-    for (auto& data : all_data) {
-        for (auto& dr : data) {
-            if (validISO(dr.iso)) {
-                dr.dmy = iso2dmy(dr.iso);
-                converted++;
+    vector<string> dates = opt.inputs;
+    bool from_stdin = dates.empty();
+    const size_t chunk = 1000;
+    string line;
+    while (true) {
+        if (from_stdin) {
+            dates.clear();
+            while (dates.size() < chunk && getline(cin, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                dates.push_back(line);
             }
+            if (dates.empty()) break;
         }
-    }
-    auto convert_end = chrono::high_resolution_clock::now();
-    result.convert_time_ms = chrono::duration_cast<chrono::milliseconds>(convert_end - convert_start).count();
-
-    // Тест валидации
-    auto valid_start = chrono::high_resolution_clock::now();
-    int valid_count = 0;
-    int error_count = 0;
-    for (auto& data : all_data) {
-        for (auto& dr : data) {
-            if (validISO(dr.iso)) {
-                valid_count++;
-            } else if (!dr.iso.empty()) {
-                error_count++;
+        if (!client.request(convertRequest(opt.mode, dates), body) || body[0] != static_cast<char>(kServeOk) ||
+            body.size() < 5 || getU32(body.data() + 1) != dates.size()) {
+            cerr << "Неверный ответ сервера\n";
+            return 1;
+        }
+        const char* p = body.data() + 5;
+        for (const auto& d : dates) {
+            auto e = static_cast<DateError>(*p++);
+            cout << d << '\t';
+            if (e == DateError::None) {
+                cout.write(p, 10);
+                p += 10;
             }
+            else {
+                cout << dateErrorCode(e);
+            }
+            cout << '\n';
         }
+        if (!from_stdin) break;
     }
-    auto valid_end = chrono::high_resolution_clock::now();
-    result.validation_time_ms = chrono::duration_cast<chrono::milliseconds>(valid_end - valid_start).count();
+    return 0;
+}
 
-    auto total_end = chrono::high_resolution_clock::now();
-    result.total_time_ms = chrono::duration_cast<chrono::milliseconds>(total_end - total_start).count();
+// Нагрузка на сервер: --connections соединений, каждое шлет запросы по
+// --dates дат подряд, ожидая ответа; даты берутся из генератора корпуса
+int batchLoadgen(const BatchOptions& opt) {
+    signal(SIGPIPE, SIG_IGN);
+    GeneratorConfig cfg;
+    cfg.error_percent = opt.error_percent;
+    cfg.error_weights = opt.error_weights;
+    cfg.error_weights[kGeneratorErrorKinds - 1] = 0;  // пропущенное поле в запросе не выразить
+    cfg.format_weights = opt.format_weights;
+    unsigned weight_sum = 0;
+    for (unsigned w : cfg.error_weights) weight_sum += w;
+    SplitMix64 rng(opt.has_seed ? opt.seed : randomSeed());
 
-    if (result.total_time_ms > 0) {
-        result.records_per_second = (result.records_processed * 1000.0) / result.total_time_ms;
+    // Набор готовых кадров, чтобы клиент не тратил время на их сборку
+    const int frame_count = 64;
+    vector<string> frames;
+    char date[32];
+    for (int f = 0; f < frame_count; f++) {
+        vector<string> dates;
+        for (int i = 0; i < opt.dates; i++) {
+            GeneratedRecord rec = drawRecord(cfg, weight_sum, rng);
+            dates.push_back(rec.error_kind >= 0 ? string(kGeneratorBadDates[rec.error_kind])
+                : string(date, writeGeneratedDate(rec, date)));
+        }
+        frames.push_back(convertRequest(opt.mode, dates));
     }
-    else {
-        result.records_per_second = 0;
+
+    int connections = max(1, opt.connections);
+    vector<PerThread<LatencyHistogram>> latency(connections);
+    atomic<long long> failed{ 0 };
+    vector<thread> threads;
+    auto start = chrono::high_resolution_clock::now();
+    for (int t = 0; t < connections; t++) {
+        threads.emplace_back([&, t]() {
+            ConvertClient client;
+            int share = opt.requests / connections + (t < opt.requests % connections);
+            if (!client.connect(opt.socket_path)) {
+                failed += share;
+                return;
+            }
+            string body;
+            for (int j = 0; j < share; j++) {
+                auto sent = chrono::high_resolution_clock::now();
+                if (!client.request(frames[(t * 7 + j) % frame_count], body) || body[0] != static_cast<char>(kServeOk)) {
+                    failed += share - j;
+                    return;
+                }
+                auto received = chrono::high_resolution_clock::now();
+                latency[t].value.record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(received - sent).count()));
+            }
+        });
     }
+    for (auto& th : threads) th.join();
+    auto end = chrono::high_resolution_clock::now();
 
-    benchmark_results.push_back(result);
+    LatencyHistogram total;
+    for (const auto& l : latency) total.merge(l.value);
+    double seconds = chrono::duration<double>(end - start).count();
+    uint64_t done = total.count();
+    cout << fixed << setprecision(1)
+        << "loadgen connections=" << connections
+        << " requests=" << done
+        << " dates=" << done * static_cast<uint64_t>(opt.dates)
+        << " failed=" << failed.load()
+        << " time_ms=" << seconds * 1000.0
+        << " req_s=" << (seconds > 0 ? done / seconds : 0.0)
+        << " dates_s=" << (seconds > 0 ? done * opt.dates / seconds : 0.0)
+        << " p50_us=" << total.percentile(0.50) / 1000.0
+        << " p99_us=" << total.percentile(0.99) / 1000.0
+        << " max_us=" << total.maximum() / 1000.0 << "\n";
 
-    // Вывод результатов
-    cout << "\n=== РЕЗУЛЬТАТЫ БЕНЧМАРКА ===\n";
-    cout << left << setw(30) << "Файлов обработано:" << n << endl;
-    cout << left << setw(30) << "Записей обработано:" << result.records_processed << endl;
-    cout << left << setw(30) << "Корректных записей:" << valid_count << endl;
-    cout << left << setw(30) << "Записей с ошибками:" << error_count << endl;
-    cout << left << setw(30) << "Время загрузки:" << result.load_time_ms << " мс\n";
-    cout << left << setw(30) << "Время конвертации:" << result.convert_time_ms << " мс\n";
-    cout << left << setw(30) << "Время валидации:" << result.validation_time_ms << " мс\n";
-    cout << left << setw(30) << "Общее время:" << result.total_time_ms << " мс\n";
-    cout << left << setw(30) << "Записей в секунду:" << fixed << setprecision(2) << result.records_per_second << endl;
-
-    // Анализ узкого места
-    cout << "\n=== АНАЛИЗ УЗКОГО МЕСТА ===\n";
-    long long max_time = max({ result.load_time_ms, result.convert_time_ms, result.validation_time_ms });
-
-    if (max_time == result.load_time_ms) {
-        cout << "Узкое место: ЗАГРУЗКА ФАЙЛОВ (" << result.load_time_ms << " мс)\n";
-        cout << "Рекомендация: Кэширование, потоковая загрузка\n";
-    }
-    else if (max_time == result.convert_time_ms) {
-        cout << "Узкое место: КОНВЕРТАЦИЯ (" << result.convert_time_ms << " мс)\n";
-        cout << "Рекомендация: Векторизация, оптимизация алгоритмов\n";
-    }
-    else {
-        cout << "Узкое место: ВАЛИДАЦИЯ (" << result.validation_time_ms << " мс)\n";
-        cout << "Рекомендация: Предварительная фильтрация, кэширование\n";
-    }
+    ConvertClient client;
+    string body;
+    if (client.connect(opt.socket_path) && client.request(statsRequest(), body)) cout << body.substr(1) << "\n";
+    return failed.load() ? 1 : 0;
 }
 
-void debugMode() {
-    printHeader("РЕЖИМ ОТЛАДКИ");
-
-    cout << "=== ИНФОРМАЦИЯ О СИСТЕМЕ ===\n";
-    cout << "Размер int: " << sizeof(int) << " байт\n";
-    cout << "Размер string: " << sizeof(string) << " байт\n";
-    cout << "Размер vector: " << sizeof(vector<DateRecord>) << " байт\n";
+#else
 
-    cout << "\n=== СОСТОЯНИЕ ПРОГРАММЫ ===\n";
-    cout << "Всего запущено тестов: " << total_tests_run << endl;
-    cout << "Пройдено тестов: " << passed_tests << endl;
-    cout << "Результатов бенчмарка: " << benchmark_results.size() << endl;
+int batchServe(const BatchOptions&) {
+    cerr << "Режим serve доступен только на системах с Unix-сокетами\n";
+    return 1;
+}
 
-    if (!benchmark_results.empty()) {
-        cout << "\n=== ПОСЛЕДНИЙ БЕНЧМАРК ===\n";
-        auto& last = benchmark_results.back();
-        cout << "Записей: " << last.records_processed << endl;
-        cout << "Общее время: " << last.total_time_ms << " мс\n";
-        cout << "Производительность: " << fixed << setprecision(2) << last.records_per_second << " зап/сек\n";
-    }
+int batchClient(const BatchOptions& opt) {
+    return batchServe(opt);
+}
 
-    cout << "\n=== ФАЙЛЫ В ПАПКЕ ===\n";
-    system("dir *.json 2>nul || ls *.json 2>/dev/null || echo 'Не удалось получить список файлов'");
+int batchLoadgen(const BatchOptions& opt) {
+    return batchServe(opt);
 }
 
-int main() {
+#endif
+
+// Интерактивное меню; итоги команд идут через menuReport()
+int runMenu() {
     setlocale(LC_ALL, "Russian");
     srand(static_cast<unsigned int>(time(nullptr)));
 
@@ -755,7 +5466,7 @@ int main() {
                 cin >> error_percent;
                 if (error_percent < 0) error_percent = 0;
                 if (error_percent > 100) error_percent = 100;
-                generateMixedFiles(n, error_percent);
+                generateMixedFiles(n, error_percent, "", &menuReport());
             }
         }
         else if (choice == 2 || choice == 3) {
@@ -786,3 +5497,41 @@ int main() {
 
     return 0;
 }
+
+int runBatch(int argc, char* argv[]) {
+    BatchOptions opt;
+    if (!parseBatchArgs(argc, argv, opt)) {
+        batchUsage();
+        return 1;
+    }
+    worker_threads = opt.threads;
+
+    if (opt.command == "convert") return batchConvert(opt);
+    if (opt.command == "analyze") return batchAnalyze(opt);
+    if (opt.command == "generate") return batchGenerate(opt);
+    if (opt.command == "serve") return batchServe(opt);
+    if (opt.command == "client") return batchClient(opt);
+    if (opt.command == "loadgen") return batchLoadgen(opt);
+    if (opt.command == "menu") {
+        menu_report_format = opt.has_report ? opt.report : ReportFormat::Text;
+        report_files = opt.verbose;
+        menu_cache = opt.cache;
+        return runMenu();
+    }
+    if (opt.command == "selftest") {
+        runSelfTests();
+        return passed_tests == total_tests_run ? 0 : 1;
+    }
+
+    batchUsage();
+    return opt.command == "help" || opt.command == "--help" ? 0 : 1;
+}
+
+#ifndef DATE_CONVERTOR_NO_MAIN
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return runBatch(argc, argv);
+    }
+    return runMenu();
+}
+#endif  // DATE_CONVERTOR_NO_MAIN
@@ -0,0 +1,83 @@
+/* Библиотека date_convertor: пакетная проверка и конвертация дат через C ABI.
+ * Буферы выделяет вызывающая сторона, библиотека не хранит состояние между
+ * вызовами и может вызываться из нескольких потоков одновременно.
+ * Коды ошибок и форматы совпадают с консольным приложением и протоколом
+ * демона (date_convertor serve). */
+#ifndef DATE_CONVERTOR_H
+#define DATE_CONVERTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(DATE_CONVERTOR_SHARED)
+#ifdef DATE_CONVERTOR_BUILD
+#define DC_API __declspec(dllexport)
+#else
+#define DC_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+#define DC_API __attribute__((visibility("default")))
+#else
+#define DC_API
+#endif
+
+/* Меняется при несовместимом изменении функций или кодов ниже */
+#define DC_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Код ошибки даты: байт на дату в буфере errors */
+enum {
+    DC_OK = 0,
+    DC_WRONG_SEPARATOR = 1,   /* 2024/12/31 */
+    DC_WRONG_ORDER = 2,       /* 31-12-2024 */
+    DC_OUT_OF_RANGE = 3,      /* 2024-13-45, год вне диапазона сборки */
+    DC_NON_DIGIT = 4,         /* abcd-ef-gh */
+    DC_TRUNCATED = 5,         /* 2024-12 */
+    DC_EMPTY = 6,             /* "" */
+    DC_TRAILING_GARBAGE = 7,  /* 2024-12-31-extra */
+    DC_MISSING_FIELD = 8      /* только в JSON: нет поля date_iso */
+};
+
+/* Выходной формат: 10 байт на дату, без завершающего нуля */
+enum {
+    DC_FORMAT_ISO = 1,        /* YYYY-MM-DD */
+    DC_FORMAT_DMY = 2,        /* DD.MM.YYYY */
+    DC_FORMAT_MDY = 3         /* MM/DD/YYYY */
+};
+
+/* Возврат пакетных функций при неизвестном формате */
+#define DC_BAD_FORMAT ((size_t)-1)
+
+/* DC_ABI_VERSION, с которой собрана библиотека */
+DC_API int dc_abi_version(void);
+
+/* Диапазон допустимых лет, заданный при сборке */
+DC_API void dc_year_range(int* min_year, int* max_year);
+
+/* Машинное имя кода ошибки ("ok", "wrong_separator", ...); "unknown" для
+ * кода вне перечисления */
+DC_API const char* dc_error_code(int error);
+
+/* Проверка одной даты в любом входном формате; возвращает код ошибки */
+DC_API int dc_check_date(const char* date, size_t length);
+
+/* Пакет упакованных ISO-дат: dates — count записей по 10 байт подряд
+ * (YYYY-MM-DD). out — count * 10 байт или NULL (только проверка), errors —
+ * count байт. Для ошибочных записей содержимое out не определено.
+ * Возвращает число корректных дат или DC_BAD_FORMAT. */
+DC_API size_t dc_convert_packed(const char* dates, size_t count, int format, char* out, uint8_t* errors);
+
+/* Пакет дат произвольной длины в любом входном формате (ISO, DD.MM.YYYY,
+ * MM/DD/YYYY, "30 ноября 2025"): dates[i] — строка длиной lengths[i] байт.
+ * out, errors и возврат — как у dc_convert_packed. */
+DC_API size_t dc_convert_strings(const char* const* dates, const size_t* lengths, size_t count, int format,
+    char* out, uint8_t* errors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATE_CONVERTOR_H */
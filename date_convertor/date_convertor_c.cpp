@@ -0,0 +1,87 @@
+// Библиотека с C ABI поверх ядра date_core.h (см. date_convertor.h)
+#include "date_convertor.h"
+#include "date_core.h"
+
+static_assert(sizeof(DateError) == sizeof(uint8_t), "буфер errors — байт на дату");
+static_assert(static_cast<int>(DateError::MissingField) == DC_MISSING_FIELD, "коды C ABI совпадают с DateError");
+
+namespace {
+
+inline size_t countValid(const uint8_t* errors, size_t count) {
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) valid += errors[i] == DC_OK;
+    return valid;
+}
+
+// Дата по ISO-представлению в формате вызывающей стороны
+inline void writeFormat(const char* iso, int format, char* out) {
+    if (format == DC_FORMAT_DMY) writeDMY(iso, out);
+    else if (format == DC_FORMAT_MDY) writeMDY(iso, out);
+    else memcpy(out, iso, 10);
+}
+
+inline bool knownFormat(int format) {
+    return format == DC_FORMAT_ISO || format == DC_FORMAT_DMY || format == DC_FORMAT_MDY;
+}
+
+}
+
+extern "C" {
+
+DC_API int dc_abi_version(void) {
+    return DC_ABI_VERSION;
+}
+
+DC_API void dc_year_range(int* min_year, int* max_year) {
+    if (min_year) *min_year = kMinYear;
+    if (max_year) *max_year = kMaxYear;
+}
+
+DC_API const char* dc_error_code(int error) {
+    // Проверка до приведения: DateError байтовое, чужой код не должен в него попасть
+    if (error < 0 || error >= kDateErrorCount) return "unknown";
+    return dateErrorCode(static_cast<DateError>(error));
+}
+
+DC_API int dc_check_date(const char* date, size_t length) {
+    int32_t ordinal;
+    return static_cast<int>(parseDate(date, length, ordinal));
+}
+
+// Ядро пишет прямо в буферы вызывающей стороны: коды ошибок — в errors
+// (DateError — байтовое перечисление), даты — в out
+DC_API size_t dc_convert_packed(const char* dates, size_t count, int format, char* out, uint8_t* errors) {
+    if (!knownFormat(format)) return DC_BAD_FORMAT;
+    auto* err = reinterpret_cast<DateError*>(errors);
+    convertPackedISO(dates, count, format == DC_FORMAT_DMY ? out : nullptr, format == DC_FORMAT_MDY ? out : nullptr, err);
+    if (out && format == DC_FORMAT_ISO && count) memcpy(out, dates, count * 10);
+    return countValid(errors, count);
+}
+
+DC_API size_t dc_convert_strings(const char* const* dates, const size_t* lengths, size_t count, int format,
+    char* out, uint8_t* errors) {
+    if (!knownFormat(format)) return DC_BAD_FORMAT;
+    size_t valid = 0;
+    char iso[10];
+    for (size_t i = 0; i < count; i++) {
+        const char* s = dates[i];
+        size_t n = s ? lengths[i] : 0;
+        int32_t ordinal = -1;
+        DateError e = parseDate(s ? s : "", n, ordinal);
+        errors[i] = static_cast<uint8_t>(e);
+        if (e != DateError::None) continue;
+        valid++;
+        if (!out) continue;
+        // Для ISO на входе строка уже нормализована; иначе дата строится по номеру дня
+        if (n == 10 && s[4] == '-') {
+            writeFormat(s, format, out + i * 10);
+        }
+        else {
+            writeOrdinalISO(ordinal, iso);
+            writeFormat(iso, format, out + i * 10);
+        }
+    }
+    return valid;
+}
+
+}
@@ -0,0 +1,571 @@
+// Ядро проверки и конвертации дат: коды ошибок, таблица дней, разбор
+// входных форматов и пакетные SIMD-ядра. Заголовок подключают консольное
+// приложение, микробенчмарки и библиотека с C ABI (date_convertor.h);
+// все функции inline, поэтому ядро встраивается в горячие циклы каждого из них.
+#ifndef DATE_CONVERTOR_CORE_H
+#define DATE_CONVERTOR_CORE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Атрибут для функций с расширенным набором инструкций (MSVC не требует флагов)
+#if defined(__GNUC__) || defined(__clang__)
+#define DC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DC_TARGET(isa)
+#endif
+
+// Категории ошибок даты — совпадают с видами ошибок, которые создает генератор
+enum class DateError : uint8_t {
+    None = 0,
+    WrongSeparator,   // 2024/12/31
+    WrongOrder,       // 31-12-2024
+    OutOfRange,       // 2024-13-45 (год, месяц или день вне диапазона)
+    NonDigit,         // abcd-ef-gh
+    Truncated,        // 2024-12
+    Empty,            // ""
+    TrailingGarbage,  // 2024-12-31-extra
+    MissingField,     // нет поля date_iso
+    Count
+};
+
+const int kDateErrorCount = static_cast<int>(DateError::Count);
+
+// Название категории для таблиц
+inline const char* dateErrorName(DateError e) {
+    switch (e) {
+    case DateError::None: return "Нет ошибки";
+    case DateError::WrongSeparator: return "Неверный разделитель";
+    case DateError::WrongOrder: return "Неверный порядок полей";
+    case DateError::OutOfRange: return "Значение вне диапазона";
+    case DateError::NonDigit: return "Недопустимые символы";
+    case DateError::Truncated: return "Неполная дата";
+    case DateError::Empty: return "Пустая строка";
+    case DateError::TrailingGarbage: return "Лишние символы";
+    case DateError::MissingField: return "Нет поля date_iso";
+    default: return "?";
+    }
+}
+
+// Код категории для машинного вывода
+inline const char* dateErrorCode(DateError e) {
+    switch (e) {
+    case DateError::None: return "ok";
+    case DateError::WrongSeparator: return "wrong_separator";
+    case DateError::WrongOrder: return "wrong_order";
+    case DateError::OutOfRange: return "out_of_range";
+    case DateError::NonDigit: return "non_digit";
+    case DateError::Truncated: return "truncated";
+    case DateError::Empty: return "empty";
+    case DateError::TrailingGarbage: return "trailing_garbage";
+    case DateError::MissingField: return "missing_field";
+    default: return "unknown";
+    }
+}
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool isDateSeparator(char c) {
+    return c == '-' || c == '/' || c == '.';
+}
+
+inline int twoDigits(const char* p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// Ровно width цифр с ведущими нулями
+inline void writeDigits(char* p, int v, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+        p[i] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    }
+}
+
+// Допустимый диапазон лет; расширяется при сборке, например
+// -DDATE_CONVERTOR_MIN_YEAR=1700 (год записывается четырьмя цифрами)
+#ifndef DATE_CONVERTOR_MIN_YEAR
+#define DATE_CONVERTOR_MIN_YEAR 1900
+#endif
+#ifndef DATE_CONVERTOR_MAX_YEAR
+#define DATE_CONVERTOR_MAX_YEAR 2100
+#endif
+
+constexpr int kMinYear = DATE_CONVERTOR_MIN_YEAR;
+constexpr int kMaxYear = DATE_CONVERTOR_MAX_YEAR;
+constexpr int kYearCount = kMaxYear - kMinYear + 1;
+static_assert(0 <= kMinYear && kMinYear <= kMaxYear && kMaxYear <= 9999, "диапазон лет: 0000-9999");
+
+// Таблица дней, построенная при компиляции: month_start[y][m] — порядковый
+// номер первого дня месяца m + 1 года kMinYear + y, считая от 01.01.kMinYear
+// (month_start[y][12] — начало следующего года). Длина месяца — разность
+// соседних элементов, поэтому проверка даты сводится к проверке границ и
+// одному чтению строки таблицы (~10 КБ для 1900-2100)
+struct DayTable {
+    uint32_t month_start[kYearCount][13] = {};
+
+    constexpr DayTable() {
+        const unsigned lengths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        uint32_t ordinal = 0;
+        for (int y = 0; y < kYearCount; y++) {
+            int year = kMinYear + y;
+            bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+            for (int m = 0; m < 12; m++) {
+                month_start[y][m] = ordinal;
+                ordinal += lengths[m] + (m == 1 && leap);
+            }
+            month_start[y][12] = ordinal;
+        }
+    }
+};
+
+constexpr DayTable kDayTable{};
+
+// Порядковый номер дня от 01.01.kMinYear или -1 для несуществующей даты
+inline int32_t dayOrdinal(unsigned year, unsigned month, unsigned day) {
+    unsigned y = year - kMinYear;
+    if (y >= unsigned(kYearCount) || month - 1 >= 12u) return -1;
+    const uint32_t* row = kDayTable.month_start[y];
+    if (day - 1 >= row[month] - row[month - 1]) return -1;
+    return static_cast<int32_t>(row[month - 1] + day - 1);
+}
+
+// Проверка полей даты (год = cc * 100 + yy) по таблице дней
+inline bool dateFieldsInRange(unsigned cc, unsigned yy, unsigned month, unsigned day) {
+    return dayOrdinal(cc * 100 + yy, month, day) >= 0;
+}
+
+// Проверка ISO-даты прямо в буфере: без исключений и выделений памяти.
+// Возвращает категорию первой найденной ошибки.
+inline DateError checkISO(const char* s, size_t n) {
+    if (n == 0) return DateError::Empty;
+    if (n < 10) return DateError::Truncated;
+
+    // Цифры на позициях YYYY, MM, DD (накапливаем без ветвлений)
+    unsigned bad_digits = 0;
+    for (int i : { 0, 1, 2, 3, 5, 6, 8, 9 }) {
+        bad_digits |= static_cast<unsigned char>(s[i] - '0') > 9;
+    }
+
+    if (s[4] != '-' || s[7] != '-') {
+        if (!bad_digits && !isDigit(s[4]) && !isDigit(s[7])) return DateError::WrongSeparator;
+        // DD-MM-YYYY, DD.MM.YYYY, MM/DD/YYYY — поля в другом порядке
+        bool dmy_shape = isDateSeparator(s[2]) && isDateSeparator(s[5]) &&
+            isDigit(s[0]) && isDigit(s[1]) && isDigit(s[3]) && isDigit(s[4]) &&
+            isDigit(s[6]) && isDigit(s[7]) && isDigit(s[8]) && isDigit(s[9]);
+        return dmy_shape ? DateError::WrongOrder : DateError::NonDigit;
+    }
+    if (bad_digits) return DateError::NonDigit;
+
+    if (!dateFieldsInRange(twoDigits(s), twoDigits(s + 2), twoDigits(s + 5), twoDigits(s + 8))) {
+        return DateError::OutOfRange;
+    }
+
+    if (n > 10) return DateError::TrailingGarbage;
+    return DateError::None;
+}
+
+inline DateError checkISO(std::string_view s) {
+    return checkISO(s.data(), s.size());
+}
+
+// Номер дня для строки, уже прошедшей checkISO
+inline int32_t isoOrdinal(const char* s) {
+    return dayOrdinal(twoDigits(s) * 100 + twoDigits(s + 2), twoDigits(s + 5), twoDigits(s + 8));
+}
+
+inline bool validISO(const std::string& s) {
+    return checkISO(s) == DateError::None;
+}
+
+// ===================== ДРУГИЕ ФОРМАТЫ ВХОДА =====================
+// Кроме ISO принимаются DD.MM.YYYY, MM/DD/YYYY и «30 ноября 2025» (месяц в
+// родительном падеже, можно с « г.» в конце). Формат определяется по длине
+// и позициям разделителей, без перебора разборщиков. DD-MM-YYYY и
+// YYYY/MM/DD остаются ошибками (WrongOrder / WrongSeparator).
+
+constexpr const char* kMonthNames[12] = { "января", "февраля", "марта", "апреля", "мая", "июня",
+    "июля", "августа", "сентября", "октября", "ноября", "декабря" };
+
+// Идеальный хеш названий месяцев: младшие байты UTF-8 первых трех букв
+// (у кириллицы первый байт — 0xD0 или 0xD1) различаются у всех двенадцати
+// названий, слот таблицы из 16 определяется одним выражением. Совпадение
+// подтверждается сравнением длины и байтов
+constexpr unsigned monthHash(const char* s) {
+    return ((static_cast<unsigned char>(s[1]) << 1) ^ (static_cast<unsigned char>(s[3]) << 4) ^
+        static_cast<unsigned char>(s[5])) & 15;
+}
+
+struct MonthHashTable {
+    uint8_t month[16] = {};  // номер месяца 1-12, 0 — пустой слот
+    uint8_t length[16] = {};
+    int collisions = 0;
+
+    constexpr MonthHashTable() {
+        for (int m = 0; m < 12; m++) {
+            unsigned h = monthHash(kMonthNames[m]);
+            if (month[h]) collisions++;
+            month[h] = static_cast<uint8_t>(m + 1);
+            uint8_t len = 0;
+            while (kMonthNames[m][len]) len++;
+            length[h] = len;
+        }
+    }
+};
+
+constexpr MonthHashTable kMonthHash{};
+static_assert(kMonthHash.collisions == 0, "хеш названий месяцев должен быть без коллизий");
+
+// Номер месяца (1-12) по названию в родительном падеже или 0
+inline unsigned monthByName(const char* s, size_t n) {
+    if (n < 6) return 0;
+    unsigned h = monthHash(s);
+    unsigned m = kMonthHash.month[h];
+    if (!m || kMonthHash.length[h] != n || memcmp(s, kMonthNames[m - 1], n) != 0) return 0;
+    return m;
+}
+
+// «30 ноября 2025» или «30 ноября 2025 г.»: номер дня, -1 для несуществующей
+// даты, -2 — строка не в этом формате
+inline int32_t textOrdinal(const char* s, size_t n) {
+    if (n >= 4 && memcmp(s + n - 4, " г.", 4) == 0) n -= 4;
+    if (n < 13 || !isDigit(s[0])) return -2;
+    size_t day_len = isDigit(s[1]) ? 2 : 1;
+    const char* month = s + day_len + 1;
+    const char* year = s + n - 4;
+    if (s[day_len] != ' ' || year[-1] != ' ' || year <= month) return -2;
+    if (!isDigit(year[0]) || !isDigit(year[1]) || !isDigit(year[2]) || !isDigit(year[3])) return -2;
+    unsigned m = monthByName(month, static_cast<size_t>(year - 1 - month));
+    if (!m) return -2;
+    unsigned day = day_len == 2 ? twoDigits(s) : static_cast<unsigned>(s[0] - '0');
+    return dayOrdinal(twoDigits(year) * 100 + twoDigits(year + 2), m, day);
+}
+
+// Разбор даты в любом поддерживаемом формате: код ошибки и номер дня
+// (-1 для ошибочных). Строка не похожа ни на один формат — категория
+// ошибки та же, что у checkISO
+inline DateError parseDate(const char* s, size_t n, int32_t& ordinal) {
+    ordinal = -1;
+    if (n == 10 && (s[2] == '.' || s[2] == '/') && s[5] == s[2]) {
+        bool digits = isDigit(s[0]) && isDigit(s[1]) && isDigit(s[3]) && isDigit(s[4]) &&
+            isDigit(s[6]) && isDigit(s[7]) && isDigit(s[8]) && isDigit(s[9]);
+        if (digits) {
+            unsigned first = twoDigits(s), second = twoDigits(s + 3);
+            unsigned year = twoDigits(s + 6) * 100 + twoDigits(s + 8);
+            ordinal = s[2] == '.' ? dayOrdinal(year, second, first) : dayOrdinal(year, first, second);
+            return ordinal >= 0 ? DateError::None : DateError::OutOfRange;
+        }
+    }
+    else if (n >= 13) {
+        int32_t day = textOrdinal(s, n);
+        if (day != -2) {
+            ordinal = day;
+            return day >= 0 ? DateError::None : DateError::OutOfRange;
+        }
+    }
+
+    DateError e = checkISO(s, n);
+    if (e == DateError::None) ordinal = isoOrdinal(s);
+    return e;
+}
+
+inline DateError parseDate(std::string_view s, int32_t& ordinal) {
+    return parseDate(s.data(), s.size(), ordinal);
+}
+
+// Дней от 01.03.0000 до 01.01 года kMinYear + 400 (годы с марта: февраль —
+// последний месяц, високосный день в конце года). Сдвиг на одну эру держит
+// счет неотрицательным и для kMinYear = 0
+constexpr int kMinYearFromMarch0 = (kMinYear + 399) * 365 + (kMinYear + 399) / 4 - (kMinYear + 399) / 100 +
+    (kMinYear + 399) / 400 + 306;
+
+// Дата ISO по номеру дня (обратное к dayOrdinal); ordinal >= 0. Без таблиц и
+// ветвлений: 400-летние эры и годы с марта (алгоритм civil_from_days Хиннанта)
+inline void writeOrdinalISO(int32_t ordinal, char* iso) {
+    int z = ordinal + kMinYearFromMarch0;      // от 01.03.0000, плюс одна эра
+    int era = z / 146097;
+    int doe = z - era * 146097;                                      // день эры [0, 146096]
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // год эры [0, 399]
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);               // день года с 1 марта
+    int mp = (5 * doy + 2) / 153;                                    // месяц с марта [0, 11]
+    int day = doy - (153 * mp + 2) / 5 + 1;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    int year = (era - 1) * 400 + yoe + (month <= 2);
+    writeDigits(iso, year, 4);
+    iso[4] = '-';
+    writeDigits(iso + 5, month, 2);
+    iso[7] = '-';
+    writeDigits(iso + 8, day, 2);
+}
+
+// ===================== ЕДИНАЯ КОНВЕРТАЦИЯ =====================
+// Строка разбирается один раз: вердикт и все запрошенные форматы за один проход.
+
+// Флаги запрашиваемых форматов (0 — только проверка)
+enum : unsigned { FORMAT_DMY = 1, FORMAT_MDY = 2 };
+
+// Пункт меню 2/3 -> формат
+inline unsigned modeFormats(int mode) {
+    return mode == 3 ? FORMAT_MDY : FORMAT_DMY;
+}
+
+struct DateConversion {
+    DateError error = DateError::None;
+    char dmy[10];
+    char mdy[10];
+};
+
+// Запись результата: iso -> DD.MM.YYYY
+inline void writeDMY(const char* iso, char* out) {
+    out[0] = iso[8]; out[1] = iso[9]; out[2] = '.';
+    out[3] = iso[5]; out[4] = iso[6]; out[5] = '.';
+    memcpy(out + 6, iso, 4);
+}
+
+// Запись результата: iso -> MM/DD/YYYY
+inline void writeMDY(const char* iso, char* out) {
+    out[0] = iso[5]; out[1] = iso[6]; out[2] = '/';
+    out[3] = iso[8]; out[4] = iso[9]; out[5] = '/';
+    memcpy(out + 6, iso, 4);
+}
+
+inline DateConversion convertISO(const char* s, size_t n, unsigned formats) {
+    DateConversion res;
+    res.error = checkISO(s, n);
+    if (res.error == DateError::None) {
+        if (formats & FORMAT_DMY) writeDMY(s, res.dmy);
+        if (formats & FORMAT_MDY) writeMDY(s, res.mdy);
+    }
+    return res;
+}
+
+inline std::string iso2dmy(const std::string& iso) {
+    DateConversion c = convertISO(iso.data(), iso.size(), FORMAT_DMY);
+    return c.error == DateError::None ? std::string(c.dmy, 10) : "";
+}
+
+inline std::string iso2mdy(const std::string& iso) {
+    DateConversion c = convertISO(iso.data(), iso.size(), FORMAT_MDY);
+    return c.error == DateError::None ? std::string(c.mdy, 10) : "";
+}
+
+// ===================== ПАКЕТНОЕ ЯДРО (SIMD) =====================
+// Вход: n упакованных 10-байтовых ISO-строк подряд. Выход: код ошибки на
+// каждую запись, порядковый номер дня (ordinal, -1 для ошибочных записей) и
+// по 10 байт на запись в каждом запрошенном формате (dst_dmy / dst_mdy /
+// ordinal, nullptr — не нужен). Для ошибочных записей содержимое текстового
+// выхода не определено. SSE4.2 обрабатывает одну запись
+// на регистр, AVX2 — две (по одной в каждой 128-битной половине).
+
+enum class SimdLevel { Scalar, SSE42, AVX2 };
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::SSE42: return "SSE4.2";
+    default: return "scalar";
+    }
+}
+
+inline void convertPackedScalar(const char* src, size_t n, char* dst_dmy, char* dst_mdy, DateError* err,
+    int32_t* ordinal = nullptr) {
+    for (size_t i = 0; i < n; i++) {
+        const char* p = src + i * 10;
+        err[i] = checkISO(p, 10);
+        if (ordinal) ordinal[i] = err[i] == DateError::None ? isoOrdinal(p) : -1;
+        if (err[i] != DateError::None) continue;
+        if (dst_dmy) writeDMY(p, dst_dmy + i * 10);
+        if (dst_mdy) writeMDY(p, dst_mdy + i * 10);
+    }
+}
+
+#ifdef DC_X86
+
+// Проверка одной записи в 128-битном регистре: формат по маскам, числа через
+// pshufb + pmaddubsw, диапазоны — по таблице месяцев
+#define DC_SSE_CONSTANTS                                                                              \
+    const __m128i zero_char = _mm_set1_epi8('0');                                                    \
+    const __m128i nine = _mm_set1_epi8(9);                                                            \
+    const __m128i dash = _mm_set1_epi8('-');                                                          \
+    const __m128i digit_pos = _mm_setr_epi8(-1, -1, -1, -1, 0, -1, -1, 0, -1, -1, 0, 0, 0, 0, 0, 0);  \
+    const __m128i sep_pos = _mm_setr_epi8(0, 0, 0, 0, -1, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0);          \
+    const __m128i pack_digits = _mm_setr_epi8(0, 1, 2, 3, 5, 6, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1); \
+    const __m128i weights = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 0, 0, 0, 0, 0, 0, 0, 0);        \
+    const __m128i dmy_shuf = _mm_setr_epi8(8, 9, -1, 5, 6, -1, 0, 1, 2, 3, -1, -1, -1, -1, -1, -1);   \
+    const __m128i dmy_sep = _mm_setr_epi8(0, 0, '.', 0, 0, '.', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);        \
+    const __m128i mdy_shuf = _mm_setr_epi8(5, 6, -1, 8, 9, -1, 0, 1, 2, 3, -1, -1, -1, -1, -1, -1);   \
+    const __m128i mdy_sep = _mm_setr_epi8(0, 0, '/', 0, 0, '/', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+
+// Разбор упакованных полей pmaddubsw: [CC, YY, MM, DD] по 16 бит -> номер дня или -1
+inline int32_t packedOrdinal(uint64_t f) {
+    return dayOrdinal((f & 0xFFFF) * 100 + ((f >> 16) & 0xFFFF), (f >> 32) & 0xFFFF, static_cast<unsigned>(f >> 48));
+}
+
+// Запись 10 байт результата; 16-байтовая запись допустима везде, кроме последней записи
+DC_TARGET("sse4.2")
+inline void storeConverted(char* dst, __m128i out, bool last) {
+    if (last) {
+        alignas(16) char tail[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(tail), out);
+        memcpy(dst, tail, 10);
+    }
+    else {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), out);
+    }
+}
+
+DC_TARGET("sse4.2")
+inline void convertPackedSSE42(const char* src, size_t n, char* dst_dmy, char* dst_mdy, DateError* err, int32_t* ordinal) {
+    DC_SSE_CONSTANTS;
+    alignas(16) char tail_in[16] = {};
+
+    for (size_t i = 0; i < n; i++) {
+        bool last = i + 1 == n;
+        const char* p = src + i * 10;
+        if (last) memcpy(tail_in, p, 10);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last ? tail_in : p));
+
+        __m128i d = _mm_sub_epi8(v, zero_char);
+        __m128i digit_ok = _mm_cmpeq_epi8(_mm_min_epu8(d, nine), d);
+        __m128i sep_ok = _mm_cmpeq_epi8(v, dash);
+        __m128i ok = _mm_or_si128(_mm_and_si128(digit_ok, digit_pos), _mm_and_si128(sep_ok, sep_pos));
+        bool format_ok = (_mm_movemask_epi8(ok) & 0x3FF) == 0x3FF;
+
+        __m128i fields = _mm_maddubs_epi16(_mm_shuffle_epi8(d, pack_digits), weights);
+        uint64_t f;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&f), fields);
+
+        if (dst_dmy) storeConverted(dst_dmy + i * 10, _mm_or_si128(_mm_shuffle_epi8(v, dmy_shuf), dmy_sep), last);
+        if (dst_mdy) storeConverted(dst_mdy + i * 10, _mm_or_si128(_mm_shuffle_epi8(v, mdy_shuf), mdy_sep), last);
+
+        int32_t day = format_ok ? packedOrdinal(f) : -1;
+        err[i] = day >= 0 ? DateError::None : checkISO(p, 10);
+        if (ordinal) ordinal[i] = day;
+    }
+}
+
+// Запись двух соседних результатов из половин 256-битного регистра
+DC_TARGET("avx2")
+inline void storeConvertedPair(char* dst, __m256i out) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(out));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 10), _mm256_extracti128_si256(out, 1));
+}
+
+DC_TARGET("avx2")
+inline void convertPackedAVX2(const char* src, size_t n, char* dst_dmy, char* dst_mdy, DateError* err, int32_t* ordinal) {
+    DC_SSE_CONSTANTS;
+    const __m256i zero_char2 = _mm256_broadcastsi128_si256(zero_char);
+    const __m256i nine2 = _mm256_broadcastsi128_si256(nine);
+    const __m256i dash2 = _mm256_broadcastsi128_si256(dash);
+    const __m256i digit_pos2 = _mm256_broadcastsi128_si256(digit_pos);
+    const __m256i sep_pos2 = _mm256_broadcastsi128_si256(sep_pos);
+    const __m256i pack_digits2 = _mm256_broadcastsi128_si256(pack_digits);
+    const __m256i weights2 = _mm256_broadcastsi128_si256(weights);
+    const __m256i dmy_shuf2 = _mm256_broadcastsi128_si256(dmy_shuf);
+    const __m256i dmy_sep2 = _mm256_broadcastsi128_si256(dmy_sep);
+    const __m256i mdy_shuf2 = _mm256_broadcastsi128_si256(mdy_shuf);
+    const __m256i mdy_sep2 = _mm256_broadcastsi128_si256(mdy_sep);
+
+    // По две записи за итерацию, пока обе 16-байтовые загрузки в пределах буфера
+    size_t i = 0;
+    for (; i + 2 < n; i += 2) {
+        const char* p = src + i * 10;
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 10)), 1);
+
+        __m256i d = _mm256_sub_epi8(v, zero_char2);
+        __m256i digit_ok = _mm256_cmpeq_epi8(_mm256_min_epu8(d, nine2), d);
+        __m256i sep_ok = _mm256_cmpeq_epi8(v, dash2);
+        __m256i ok = _mm256_or_si256(_mm256_and_si256(digit_ok, digit_pos2), _mm256_and_si256(sep_ok, sep_pos2));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(ok));
+
+        __m256i fields = _mm256_maddubs_epi16(_mm256_shuffle_epi8(d, pack_digits2), weights2);
+        uint64_t f0, f1;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&f0), _mm256_castsi256_si128(fields));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&f1), _mm256_extracti128_si256(fields, 1));
+
+        if (dst_dmy) storeConvertedPair(dst_dmy + i * 10, _mm256_or_si256(_mm256_shuffle_epi8(v, dmy_shuf2), dmy_sep2));
+        if (dst_mdy) storeConvertedPair(dst_mdy + i * 10, _mm256_or_si256(_mm256_shuffle_epi8(v, mdy_shuf2), mdy_sep2));
+
+        int32_t day0 = (mask & 0x3FF) == 0x3FF ? packedOrdinal(f0) : -1;
+        int32_t day1 = ((mask >> 16) & 0x3FF) == 0x3FF ? packedOrdinal(f1) : -1;
+        err[i] = day0 >= 0 ? DateError::None : checkISO(p, 10);
+        err[i + 1] = day1 >= 0 ? DateError::None : checkISO(p + 10, 10);
+        if (ordinal) {
+            ordinal[i] = day0;
+            ordinal[i + 1] = day1;
+        }
+    }
+
+    if (i < n) {
+        convertPackedSSE42(src + i * 10, n - i,
+            dst_dmy ? dst_dmy + i * 10 : nullptr, dst_mdy ? dst_mdy + i * 10 : nullptr, err + i,
+            ordinal ? ordinal + i : nullptr);
+    }
+}
+
+#undef DC_SSE_CONSTANTS
+
+#endif // DC_X86
+
+// Определение набора инструкций один раз при старте.
+// DATE_CONVERTOR_SIMD=scalar|sse42 позволяет принудительно понизить уровень.
+inline SimdLevel detectSimdLevel() {
+    SimdLevel level = SimdLevel::Scalar;
+#ifdef DC_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool sse42 = (info[2] & (1 << 20)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (avx && max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) level = SimdLevel::AVX2;
+    else if (sse42) level = SimdLevel::SSE42;
+#endif
+
+    if (const char* forced = getenv("DATE_CONVERTOR_SIMD")) {
+        std::string f = forced;
+        if (f == "scalar") level = SimdLevel::Scalar;
+        else if (f == "sse42" && level == SimdLevel::AVX2) level = SimdLevel::SSE42;
+    }
+    return level;
+}
+
+inline const SimdLevel simd_level = detectSimdLevel();
+
+// Пакетная проверка и конвертация с выбором ядра по возможностям процессора
+inline void convertPackedISO(const char* src, size_t n, char* dst_dmy, char* dst_mdy, DateError* err,
+    int32_t* ordinal = nullptr) {
+    if (n == 0) return;
+#ifdef DC_X86
+    if (simd_level == SimdLevel::AVX2) return convertPackedAVX2(src, n, dst_dmy, dst_mdy, err, ordinal);
+    if (simd_level == SimdLevel::SSE42) return convertPackedSSE42(src, n, dst_dmy, dst_mdy, err, ordinal);
+#endif
+    convertPackedScalar(src, n, dst_dmy, dst_mdy, err, ordinal);
+}
+
+#endif // DATE_CONVERTOR_CORE_H
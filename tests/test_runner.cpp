@@ -1,54 +1,87 @@
-#include <iostream>
-#include <cassert>
-
-// Функции из date_convertor (заглушки для компиляции)
-bool isLeapYear(int year) { 
-    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0); 
-}
-
-bool isValidDate(int day, int month, int year) {
-    if (month < 1 || month > 12) return false;
-    if (day < 1) return false;
-    
-    int daysInMonth[] = {31,28,31,30,31,30,31,31,30,31,30,31};
-    if (isLeapYear(year) && month == 2) daysInMonth[1] = 29;
-    
-    return day <= daysInMonth[month-1];
-}
-
-std::string normalizeToISO(const std::string& rawDate) {
-    // Простая заглушка - возвращает как есть для ISO формата
-    return rawDate;
-}
-
-void runTests() {
-    std::cout << "Тесты валидации дат\n";
-    
-    // 1. Тест високосных годов
-    assert(isLeapYear(2020) && "2020 високосный");
-    assert(isLeapYear(2000) && "2000 високосный");
-    assert(!isLeapYear(2021) && "2021 не високосный");
-    assert(!isLeapYear(1900) && "1900 не високосный");
-    std::cout << "✓ Високосные годы\n";
-    
-    // 2. Тест валидных дат
-    assert(isValidDate(1, 1, 2023) && "01.01.2023 валидна");
-    assert(isValidDate(31, 12, 2023) && "31.12.2023 валидна");
-    assert(isValidDate(29, 2, 2020) && "29.02.2020 валидна");
-    assert(!isValidDate(29, 2, 2021) && "29.02.2021 невалидна");
-    assert(!isValidDate(32, 1, 2023) && "32.01.2023 невалидна");
-    assert(!isValidDate(31, 13, 2023) && "31.13.2023 невалидна");
-    std::cout << "✓ Валидация дат\n";
-    
-    // 3. Тест нормализации (упрощенный)
-    assert(normalizeToISO("2023-12-31") == "2023-12-31");
-    std::cout << "✓ Нормализация\n";
-    
-    std::cout << "\nВсе тесты пройдены ✓\n";
-}
-
-int main() {
-    setlocale(LC_ALL, "ru_RU.UTF-8");
-    runTests();
-    return 0;
-}
+// assert должен срабатывать и в Release-сборке
+#undef NDEBUG
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "date_convertor.h"
+
+// Проверки через C ABI библиотеки date_convertor_core
+int checkDate(int day, int month, int year) {
+    char iso[16];
+    snprintf(iso, sizeof(iso), "%04d-%02d-%02d", year, month, day);
+    return dc_check_date(iso, strlen(iso));
+}
+
+bool isLeapYear(int year) {
+    return checkDate(29, 2, year) == DC_OK;
+}
+
+bool isValidDate(int day, int month, int year) {
+    return checkDate(day, month, year) == DC_OK;
+}
+
+std::string normalizeToISO(const std::string& rawDate) {
+    const char* dates[] = { rawDate.c_str() };
+    size_t lengths[] = { rawDate.size() };
+    char out[10];
+    uint8_t error;
+    if (dc_convert_strings(dates, lengths, 1, DC_FORMAT_ISO, out, &error) != 1) return "";
+    return std::string(out, 10);
+}
+
+void runTests() {
+    std::cout << "Тесты валидации дат\n";
+
+    // 1. Тест високосных годов
+    assert(isLeapYear(2020) && "2020 високосный");
+    assert(isLeapYear(2000) && "2000 високосный");
+    assert(!isLeapYear(2021) && "2021 не високосный");
+    assert(!isLeapYear(1900) && "1900 не високосный");
+    std::cout << "✓ Високосные годы\n";
+
+    // 2. Тест валидных дат
+    assert(isValidDate(1, 1, 2023) && "01.01.2023 валидна");
+    assert(isValidDate(31, 12, 2023) && "31.12.2023 валидна");
+    assert(isValidDate(29, 2, 2020) && "29.02.2020 валидна");
+    assert(!isValidDate(29, 2, 2021) && "29.02.2021 невалидна");
+    assert(!isValidDate(32, 1, 2023) && "32.01.2023 невалидна");
+    assert(!isValidDate(31, 13, 2023) && "31.13.2023 невалидна");
+    std::cout << "✓ Валидация дат\n";
+
+    // 3. Тест нормализации
+    assert(normalizeToISO("2023-12-31") == "2023-12-31");
+    assert(normalizeToISO("31.12.2023") == "2023-12-31");
+    assert(normalizeToISO("12/31/2023") == "2023-12-31");
+    assert(normalizeToISO("31 декабря 2023 г.") == "2023-12-31");
+    assert(normalizeToISO("2023/12/31").empty());
+    std::cout << "✓ Нормализация\n";
+
+    // 4. Пакет упакованных дат: результат и коды ошибок в буферах вызывающего
+    const char packed[] = "2024-12-312024-13-012024/12/312024-00-102024-02-29";
+    const size_t count = 5;
+    char out[count * 10];
+    uint8_t errors[count];
+    assert(dc_abi_version() == DC_ABI_VERSION);
+    assert(dc_convert_packed(packed, count, DC_FORMAT_DMY, out, errors) == 2);
+    assert(errors[0] == DC_OK && std::string(out, 10) == "31.12.2024");
+    assert(errors[1] == DC_OUT_OF_RANGE && errors[2] == DC_WRONG_SEPARATOR && errors[3] == DC_OUT_OF_RANGE);
+    assert(errors[4] == DC_OK && std::string(out + 40, 10) == "29.02.2024");
+    assert(dc_convert_packed(packed, count, DC_FORMAT_MDY, nullptr, errors) == 2);
+    assert(dc_convert_packed(packed, count, 0, out, errors) == DC_BAD_FORMAT);
+    assert(std::string(dc_error_code(DC_WRONG_SEPARATOR)) == "wrong_separator");
+    assert(std::string(dc_error_code(DC_MISSING_FIELD + 1)) == "unknown");
+    assert(std::string(dc_error_code(-1)) == "unknown");
+    assert(std::string(dc_error_code(256)) == "unknown");
+    std::cout << "✓ Пакетный C ABI\n";
+
+    std::cout << "\nВсе тесты пройдены ✓\n";
+}
+
+int main() {
+    setlocale(LC_ALL, "ru_RU.UTF-8");
+    runTests();
+    return 0;
+}